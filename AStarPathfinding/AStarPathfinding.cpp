@@ -2,6 +2,7 @@
 //
 
 #include <iostream>
+#include <cstdlib>
 #include <cassert>
 #include <vector>
 #include <array>
@@ -13,17 +14,18 @@
 #include <future>
 #include <thread>
 #include <fstream>
+#include <string>
 
 #include "World/FieldType.h"
 #include "Math/Vector2d.h"
 #include "World/Map2d.h"
+#include "World/MapLoader.h"
 #include "PathFinder/AStarPathFinder.h"
+#include "View/ConsoleRenderer.h"
+#include "View/ConsoleInput.h"
 
 namespace
 {
-	constexpr char InputObstacle = '1';
-	constexpr char InputEmptyField = '0';
-
 	constexpr char Obstacle = 'X';
 	constexpr char EmptyField = ' ';
 	constexpr char BeginPath = 'b';
@@ -34,12 +36,15 @@ namespace
 
 	constexpr size_t MaxViewWidth = 79;
 	constexpr size_t MaxViewHeight = 65;
+	constexpr ptrdiff_t ViewMoveStep = 4;
+	//search events kept between two frames, more are dropped until the next frame
+	constexpr size_t SearchEventCapacity = size_t(1) << 18;
 
 	constexpr bool HasDiagonalMove = true;
 	constexpr bool Debug = true;
 	constexpr bool SaveToFile = true;
 	constexpr bool Async = true;
-	constexpr double FPS = 1.;
+	constexpr double FPS = 30.;
 	constexpr size_t FrameTime = size_t(1000. / FPS);
 
 	constexpr Math::Vector2d DefaultBeginPosition{ 0, 0 };
@@ -93,20 +98,6 @@ void renderMap(Math::Matrix2d<char>& view, const Math::Matrix2d<World::FieldType
 	}
 }
 
-void draw(const Math::Matrix2d<char>& view)
-{
-	for (size_t x = 0; x < view.GetHeight(); ++x)
-	{
-		for (size_t y = 0; y < view.GetWidth(); ++y)
-		{
-			Math::Vector2d position{ x, y };
-			auto&& field = view.GetField(position);
-			std::cout.put(field);
-		}
-		std::cout.put('\n');
-	}
-	std::cout.flush();
-}
 void renderPathFinder(Math::Matrix2d<char>& view, const PathFinder::AStarPathFinder& pathFinder, bool hasDebug = false)
 {
 	const bool found = pathFinder.GetResult() == PathFinder::IPathFinderResult::Found;
@@ -128,57 +119,46 @@ void renderPathFinder(Math::Matrix2d<char>& view, const PathFinder::AStarPathFin
 	}
 }
 
-World::Map2d loadMap(std::string fileName, Math::Vector2d& beginPosition, Math::Vector2d& endPosition)
+void saveMap(std::string fileName, const Math::Matrix2d<char>& view)
 {
-	std::ifstream input(fileName, std::ios::in);
-
-	assert(input.is_open());
-
-	size_t width, height;
-	input >> width >> height;
+	std::ofstream output(fileName, std::ios::out);
 
-	World::Map2d map(width, height);
+	std::string row;
+	row.reserve(view.GetWidth() + 1);
 
-	std::string buf;
-	for (size_t x = 0; x < map.GetHeight(); ++x)
+	for (size_t x = 0; x < view.GetHeight(); ++x)
 	{
-		input >> buf;
-		for (size_t y = 0; y < map.GetWidth(); ++y)
+		row.clear();
+		for (size_t y = 0; y < view.GetWidth(); ++y)
 		{
 			Math::Vector2d position{ x, y };
-
-			switch (buf[y])
-			{
-			case InputEmptyField: map.SetField(position, World::FieldType::None); break;
-			case InputObstacle: map.SetField(position, World::FieldType::Obstacle); break;
-			case BeginPath: beginPosition = position; break;
-			case EndPath: endPosition = position; break;
-			}
+			row += view.GetField(position);
 		}
+		row += '\n';
+		output.write(row.data(), std::streamsize(row.size()));
 	}
+	output.flush();
 
-	input.close();
-
-	return map;
+	output.close();
 }
 
-void saveMap(std::string fileName, const Math::Matrix2d<char>& view)
+std::string getStatus(const PathFinder::AStarPathFinder& pathFinder, bool pathFinderStopped, const Math::Vector2d& viewOrigin)
 {
-	std::ofstream output(fileName, std::ios::out);
-
-	for (size_t x = 0; x < view.GetHeight(); ++x)
+	std::string status;
+	if (pathFinderStopped)
 	{
-		for (size_t y = 0; y < view.GetWidth(); ++y)
-		{
-			Math::Vector2d position{ x, y };
-			auto&& field = view.GetField(position);
-			output.put(field);
-		}
-		output.put('\n');
+		const bool found = pathFinder.GetResult() == PathFinder::IPathFinderResult::Found;
+		status += found ? "Path found\n" : "Path not found\n";
+		if (found)
+			status += "Path length: " + std::to_string(size_t(pathFinder.GetPath().GetLength()));
 	}
-	output.flush();
+	else
+	{
+		status += "Finding a path\n";
+	}
+	status += "\nView: " + std::to_string(viewOrigin.X) + ", " + std::to_string(viewOrigin.Y) + " (w/a/s/d or arrows - move, r - redraw, q - quit)";
 
-	output.close();
+	return status;
 }
 
 int main()
@@ -186,8 +166,11 @@ int main()
 	Math::Vector2d beginPosition = DefaultBeginPosition;
 	Math::Vector2d endPosition = DefaultEndPosition;
 
-	//auto map = loadMap("input_1000_1000.txt", beginPosition, endPosition);// generateMap();
-	auto map = loadMap("input.txt", beginPosition, endPosition);
+	World::Map2d map(0, 0);
+	//const bool loaded = World::LoadMap("input_1000_1000.txt", map, beginPosition, endPosition);// generateMap();
+	const bool loaded = World::LoadMap("input.txt", map, beginPosition, endPosition);
+	assert(loaded);
+	(void)loaded;
 
 	//force empty field
 	map.SetField(beginPosition, World::FieldType::None);
@@ -195,8 +178,11 @@ int main()
 
 	//copy map for async path finding
 	auto mapAsync = map;
+	PathFinder::SearchEventBuffer events(SearchEventCapacity);
 	PathFinder::AStarPathFinder pathFinder(mapAsync);
 	pathFinder.SetHasDiagonalMove(HasDiagonalMove);
+	if (Debug)
+		pathFinder.SetSearchEvents(&events);
 
 	std::future<PathFinder::IPathFinderResult> future =
 		std::async(Async ? std::launch::async : std::launch::deferred, [&]()
@@ -204,12 +190,37 @@ int main()
 				return pathFinder.FindPath(beginPosition, endPosition);
 			});
 
+	//the map is static: it is rendered once, search results are drawn over it when the search stops
 	Math::Matrix2d<char> view(map.GetWidth(), map.GetHeight());
+	renderMap(view, map.GetFields());
+	view.SetField(beginPosition, BeginPath);
+	view.SetField(endPosition, EndPath);
+
+	View::ConsoleRenderer renderer(std::cout, MaxViewWidth, MaxViewHeight);
+	View::ConsoleInput input;
+
 	bool pathFinderStopped = false;
+	bool running = true;
 
-	while (true)
+	while (running)
 	{
 		const bool wasStopped = pathFinderStopped;
+
+		//input
+		for (int key = input.ReadKey(); key != 0; key = input.ReadKey())
+		{
+			switch (key)
+			{
+			case 'w': renderer.Move(-ViewMoveStep, 0); break;
+			case 's': renderer.Move(ViewMoveStep, 0); break;
+			case 'a': renderer.Move(0, -ViewMoveStep); break;
+			case 'd': renderer.Move(0, ViewMoveStep); break;
+			case 'r': renderer.Invalidate(); break;
+			case 'q':
+			case View::ConsoleInput::InterruptKey: running = false; break;
+			}
+		}
+
 		//update
 		if (future.valid())
 		{
@@ -224,39 +235,32 @@ int main()
 			}
 		}
 
-		//draw to view
-		renderMap(view, map.GetFields());
-		if (pathFinderStopped)
+		//draw search progress to view, events are consumed after the stop check, so none are left for a stopped search
+		if (Debug && events.ConsumeAll([&view](const PathFinder::SearchEvent& event)
+			{
+				view.SetField(event.Position, event.Type == PathFinder::SearchEventType::Opened ? OpenListFieldPath : ClosedListFieldPath);
+			}) > 0u)
 		{
-			renderPathFinder(view, pathFinder, Debug);
+			view.SetField(beginPosition, BeginPath);
+			view.SetField(endPosition, EndPath);
 		}
-		view.SetField(beginPosition, BeginPath);
-		view.SetField(endPosition, EndPath);
 
-		//draw to console
-		system("cls");
-		if (pathFinderStopped)
-		{
-			const bool found = pathFinder.GetResult() == PathFinder::IPathFinderResult::Found;
-			std::cout << (found ? "Path found\n" : "Path not found\nn");
-			if (found)
-				std::cout << "Path length: " << pathFinder.GetPath().GetLength() << "\n";
-		}
-		else
+		//draw the final search state to view, it also restores fields of dropped events
+		if (wasStopped != pathFinderStopped)
 		{
-			std::cout << "Finding a path\n\n";
-		}
-
-		//todo draggable view
-		if(view.GetWidth() <= MaxViewWidth && view.GetHeight() <= MaxViewHeight)
-			draw(view);
+			renderPathFinder(view, pathFinder, Debug);
+			view.SetField(beginPosition, BeginPath);
+			view.SetField(endPosition, EndPath);
 
-		//save to file
-		if (wasStopped != pathFinderStopped && SaveToFile)
-		{
-			saveMap("output.txt", view);
+			//save to file
+			if (SaveToFile)
+				saveMap("output.txt", view);
 		}
 
+		//draw to console, only changed fields of the viewport are written
+		renderer.SetStatus(getStatus(pathFinder, pathFinderStopped, renderer.GetOrigin()));
+		renderer.Draw(view);
+
 		std::this_thread::sleep_for(std::chrono::milliseconds(FrameTime));
 	}
 }
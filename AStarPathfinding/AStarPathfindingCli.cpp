@@ -0,0 +1,524 @@
+// AStarPathfindingCli.cpp : пакетный запуск поиска пути без консольной отрисовки.
+//
+// usage: AStarPathfindingCli --map <file> --queries <file> [options]
+//
+// queries file: one query per line "beginX beginY endX endY", '#' starts a comment line
+// snapshot: map, connectivity labels and contraction hierarchy in one memory mapped file;
+//           labels and hierarchy are kept for the moves of the run which added them
+// output: one line per query "index found|notfound length time_us [x,y ...]",
+//         path is written from the first step to the end position
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+
+#include "Math/Vector2d.h"
+#include "World/Map2d.h"
+#include "World/MapLoader.h"
+#include "World/ConnectivityLabels.h"
+#include "Storage/Snapshot.h"
+#include "PathFinder/IPathFinder.h"
+#include "PathFinder/AStarPathFinder.h"
+#include "PathFinder/ContractionHierarchy.h"
+#include "PathFinder/ContractionHierarchyPathFinder.h"
+#include "PathFinder/ParallelAStarPathFinder.h"
+#include "PathFinder/FixedPointAStarPathFinder.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr size_t OutputBufferSize = 1u << 20;
+	constexpr size_t MaxThreadCount = 1024u;
+
+	struct Options final
+	{
+		std::string MapFileName;
+		std::string QueriesFileName;
+		std::string OutputFileName;
+		std::string FinderName = "astar";
+		std::string ContractionHierarchyFileName;
+		std::string SnapshotFileName;
+		size_t ThreadCount = 0u;
+		uint32_t StraightCost = PathFinder::FixedPointAStarPathFinder::DefaultStraightCost;
+		uint32_t DiagonalCost = PathFinder::FixedPointAStarPathFinder::DefaultDiagonalCost;
+		PathFinder::AStarTieBreaking TieBreaking = PathFinder::AStarTieBreaking::Fifo;
+		PathFinder::AStarSearchMode SearchMode = PathFinder::AStarSearchMode::Optimal;
+		double Epsilon = 0.;
+		bool HasDiagonalMove = true;
+		bool WritePaths = true;
+	};
+
+	struct Query final
+	{
+		Math::Vector2d Begin;
+		Math::Vector2d End;
+	};
+
+	void printUsage()
+	{
+		std::cerr <<
+			"usage: AStarPathfindingCli --map <file> | --snapshot <file> --queries <file> [options]\n"
+			"  --output <file>     write results to file instead of stdout\n"
+			"  --finder <name>     astar | fixed | ch | parallel (default: astar)\n"
+			"  --ch-index <file>   contraction hierarchy index, built and saved if the file can not be loaded\n"
+			"  --snapshot <file>   map and precomputed data, built from --map if the file can not be loaded or was built from\n"
+			"                      another version of --map; data the file does not have yet is added after the run\n"
+			"  --threads <count>   threads of the parallel finder, 0 - hardware concurrency (default: 0)\n"
+			"  --move-costs <s,d>  integer straight and diagonal move costs of the fixed finder (default: 256,362)\n"
+			"  --tie-breaking <p>  fifo | lifo | g | cross, astar finder order among equal f (default: fifo)\n"
+			"  --search <mode>     optimal | weighted | focal, astar finder mode (default: optimal)\n"
+			"  --epsilon <value>   path weight of weighted and focal modes is at most (1 + epsilon) * optimal\n"
+			"  --no-diagonal       4 way moves\n"
+			"  --no-paths          write only result, length and time\n";
+	}
+
+	bool parseTieBreaking(const std::string& name, PathFinder::AStarTieBreaking& tieBreaking)
+	{
+		if (name == "fifo")
+			tieBreaking = PathFinder::AStarTieBreaking::Fifo;
+		else if (name == "lifo")
+			tieBreaking = PathFinder::AStarTieBreaking::Lifo;
+		else if (name == "g")
+			tieBreaking = PathFinder::AStarTieBreaking::LargerG;
+		else if (name == "cross")
+			tieBreaking = PathFinder::AStarTieBreaking::CrossProduct;
+		else
+			return false;
+		return true;
+	}
+
+	bool parseSearchMode(const std::string& name, PathFinder::AStarSearchMode& mode)
+	{
+		if (name == "optimal")
+			mode = PathFinder::AStarSearchMode::Optimal;
+		else if (name == "weighted")
+			mode = PathFinder::AStarSearchMode::Weighted;
+		else if (name == "focal")
+			mode = PathFinder::AStarSearchMode::Focal;
+		else
+			return false;
+		return true;
+	}
+
+	//digits only: the stream would wrap "-1" around and ignore trailing characters
+	bool parseMoveCost(const std::string& value, uint32_t& cost)
+	{
+		std::istringstream stream(value);
+		uint64_t result = 0u;
+		if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || !(stream >> result) ||
+			result > std::numeric_limits<uint32_t>::max())
+			return false;
+
+		cost = uint32_t(result);
+		return true;
+	}
+
+	bool parseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (arg == "--map" && hasValue)
+				options.MapFileName = argv[++i];
+			else if (arg == "--queries" && hasValue)
+				options.QueriesFileName = argv[++i];
+			else if (arg == "--output" && hasValue)
+				options.OutputFileName = argv[++i];
+			else if (arg == "--finder" && hasValue)
+				options.FinderName = argv[++i];
+			else if (arg == "--ch-index" && hasValue)
+				options.ContractionHierarchyFileName = argv[++i];
+			else if (arg == "--snapshot" && hasValue)
+				options.SnapshotFileName = argv[++i];
+			else if (arg == "--threads" && hasValue)
+			{
+				//the stream would wrap "-1" around, only digits are accepted
+				const std::string value = argv[++i];
+				std::istringstream stream(value);
+				if (value.find_first_not_of("0123456789") != std::string::npos || !(stream >> options.ThreadCount) ||
+					options.ThreadCount > MaxThreadCount)
+				{
+					std::cerr << "threads must be a number from 0 (hardware concurrency) to " << MaxThreadCount << "\n";
+					return false;
+				}
+			}
+			else if (arg == "--move-costs" && hasValue)
+			{
+				const std::string value = argv[++i];
+				const size_t separator = value.find(',');
+				if (separator == std::string::npos ||
+					!parseMoveCost(value.substr(0, separator), options.StraightCost) ||
+					!parseMoveCost(value.substr(separator + 1u), options.DiagonalCost) ||
+					options.StraightCost == 0u || options.DiagonalCost < options.StraightCost ||
+					uint64_t(options.DiagonalCost) > 2u * uint64_t(options.StraightCost))
+				{
+					std::cerr << "move costs must be \"straight,diagonal\" with straight <= diagonal <= 2 * straight\n";
+					return false;
+				}
+			}
+			else if (arg == "--tie-breaking" && hasValue)
+			{
+				if (!parseTieBreaking(argv[++i], options.TieBreaking))
+				{
+					std::cerr << "unknown tie breaking: " << argv[i] << "\n";
+					return false;
+				}
+			}
+			else if (arg == "--search" && hasValue)
+			{
+				if (!parseSearchMode(argv[++i], options.SearchMode))
+				{
+					std::cerr << "unknown search mode: " << argv[i] << "\n";
+					return false;
+				}
+			}
+			else if (arg == "--epsilon" && hasValue)
+			{
+				std::istringstream stream(argv[++i]);
+				char rest = 0;
+				if (!(stream >> options.Epsilon) || stream >> rest || !(options.Epsilon >= 0.) ||
+					!(options.Epsilon <= PathFinder::AStarPathFinder::MaxEpsilon))
+				{
+					std::cerr << "epsilon must be a number from 0 to " << PathFinder::AStarPathFinder::MaxEpsilon << "\n";
+					return false;
+				}
+			}
+			else if (arg == "--no-diagonal")
+				options.HasDiagonalMove = false;
+			else if (arg == "--no-paths")
+				options.WritePaths = false;
+			else
+			{
+				std::cerr << "unknown option: " << arg << "\n";
+				return false;
+			}
+		}
+
+		return (!options.MapFileName.empty() || !options.SnapshotFileName.empty()) && !options.QueriesFileName.empty();
+	}
+
+	//positions must be inside the map, the finders do not check them
+	bool loadQueries(const std::string& fileName, const World::Map2d& map, std::vector<Query>& queries)
+	{
+		std::ifstream input(fileName, std::ios::in);
+		if (!input.is_open())
+			return false;
+
+		std::string line;
+		size_t lineNumber = 0u;
+		while (std::getline(input, line))
+		{
+			++lineNumber;
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream stream(line);
+			Query query;
+			if (!(stream >> query.Begin.X >> query.Begin.Y >> query.End.X >> query.End.Y))
+			{
+				std::cerr << "line " << lineNumber << ": query must be \"beginX beginY endX endY\"\n";
+				return false;
+			}
+			if (!map.IsInside(query.Begin) || !map.IsInside(query.End))
+			{
+				std::cerr << "line " << lineNumber << ": query is outside of the map, X < " << map.GetHeight() << ", Y < " << map.GetWidth() << "\n";
+				return false;
+			}
+
+			queries.emplace_back(query);
+		}
+
+		return true;
+	}
+
+	double getSeconds(Clock::time_point begin, Clock::time_point end)
+	{
+		return std::chrono::duration<double>(end - begin).count();
+	}
+
+	//owns the finder and everything it refers to
+	struct Finder final
+	{
+		std::unique_ptr<PathFinder::ContractionHierarchy> Hierarchy;
+		std::unique_ptr<PathFinder::IPathFinder<Math::Vector2d>> PathFinder;
+		//set for the astar finder, it counts expansions
+		const PathFinder::AStarPathFinder* AStarPathFinder = nullptr;
+	};
+
+	//with --map the snapshot is used only if it was built from the same map file
+	bool loadSnapshot(const Options& options, Storage::Snapshot& snapshot, World::Map2d& map, World::MapFileInfo& mapFileInfo)
+	{
+		if (options.SnapshotFileName.empty() || !snapshot.Open(options.SnapshotFileName) || !World::LoadMap(snapshot, map, mapFileInfo))
+			return false;
+
+		World::MapFileInfo currentInfo;
+		if (!options.MapFileName.empty() && (!World::GetMapFileInfo(options.MapFileName, currentInfo) || currentInfo != mapFileInfo))
+		{
+			std::cerr << "snapshot was built from another version of the map: " << options.SnapshotFileName << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	//labels for any moves
+	bool loadLabels(const Storage::Snapshot& snapshot, const World::Map2d& map, World::ConnectivityLabels& labels)
+	{
+		return labels.Load(snapshot) && labels.GetWidth() == map.GetWidth() && labels.GetHeight() == map.GetHeight();
+	}
+
+	//hierarchy for any moves
+	bool loadHierarchy(const Storage::Snapshot& snapshot, const World::Map2d& map, PathFinder::ContractionHierarchy& hierarchy)
+	{
+		return hierarchy.Load(snapshot) && hierarchy.GetWidth() == map.GetWidth() && hierarchy.GetHeight() == map.GetHeight();
+	}
+
+	//sections the open snapshot already has are kept, even if they are built for the other moves,
+	//so a run never drops data of another run; missing sections are added from this run.
+	//The snapshot is closed before the new file replaces it.
+	bool updateSnapshot(const std::string& fileName, Storage::Snapshot& snapshot, const World::Map2d& map, const World::MapFileInfo& mapFileInfo,
+		const World::ConnectivityLabels& labels, const Finder& finder)
+	{
+		World::ConnectivityLabels snapshotLabels;
+		PathFinder::ContractionHierarchy snapshotHierarchy;
+		bool hasLabels = false;
+		bool hasHierarchy = false;
+
+		if (snapshot.IsOpen())
+		{
+			hasLabels = loadLabels(snapshot, map, snapshotLabels);
+			if (hasLabels && finder.Hierarchy == nullptr)
+				return true;
+
+			//the hierarchy is validated only if it can be missing, it is a full pass over the index
+			hasHierarchy = loadHierarchy(snapshot, map, snapshotHierarchy);
+			if (hasLabels && hasHierarchy)
+				return true;
+		}
+
+		Storage::SnapshotWriter writer;
+		const bool written = writer.Open(fileName) &&
+			World::AddToSnapshot(map, mapFileInfo, writer) &&
+			(hasLabels ? snapshotLabels : labels).AddToSnapshot(writer) &&
+			(hasHierarchy ? snapshotHierarchy.AddToSnapshot(writer) : (finder.Hierarchy == nullptr || finder.Hierarchy->AddToSnapshot(writer)));
+
+		//sections are copied, the mapped file is not used any more
+		snapshot.Close();
+		return written && writer.Close();
+	}
+
+	bool createFinder(const Options& options, const World::Map2d& map, const Storage::Snapshot& snapshot, Finder& finder)
+	{
+		if (options.FinderName == "astar")
+		{
+			auto pathFinder = std::make_unique<PathFinder::AStarPathFinder>(map);
+			pathFinder->SetHasDiagonalMove(options.HasDiagonalMove);
+			pathFinder->SetTieBreaking(options.TieBreaking);
+			pathFinder->SetSearchMode(options.SearchMode, options.Epsilon);
+			finder.AStarPathFinder = pathFinder.get();
+			finder.PathFinder = std::move(pathFinder);
+			return true;
+		}
+
+		if (options.FinderName == "fixed")
+		{
+			auto pathFinder = std::make_unique<PathFinder::FixedPointAStarPathFinder>(map);
+			pathFinder->SetHasDiagonalMove(options.HasDiagonalMove);
+			if (!pathFinder->SetMoveCosts(options.StraightCost, options.DiagonalCost))
+			{
+				std::cerr << "move costs " << options.StraightCost << "," << options.DiagonalCost
+					<< " do not fit 32 bit path costs on this map\n";
+				return false;
+			}
+			finder.PathFinder = std::move(pathFinder);
+			return true;
+		}
+
+		if (options.FinderName == "ch")
+		{
+			finder.Hierarchy = std::make_unique<PathFinder::ContractionHierarchy>();
+			auto& hierarchy = *finder.Hierarchy;
+
+			const auto begin = Clock::now();
+			auto isLoaded = [&](bool loaded)
+			{
+				return loaded && hierarchy.GetWidth() == map.GetWidth() && hierarchy.GetHeight() == map.GetHeight() &&
+					hierarchy.HasDiagonalMove() == options.HasDiagonalMove;
+			};
+
+			const bool loaded = (snapshot.IsOpen() && isLoaded(hierarchy.Load(snapshot))) ||
+				(!options.ContractionHierarchyFileName.empty() && isLoaded(hierarchy.Load(options.ContractionHierarchyFileName)));
+
+			if (!loaded)
+			{
+				hierarchy.Build(map, options.HasDiagonalMove);
+				if (!options.ContractionHierarchyFileName.empty() && !hierarchy.Save(options.ContractionHierarchyFileName))
+					std::cerr << "can not save contraction hierarchy: " << options.ContractionHierarchyFileName << "\n";
+			}
+
+			std::cerr << (loaded ? "ch loaded: " : "ch built: ") << getSeconds(begin, Clock::now()) << " s, "
+				<< hierarchy.GetNodeCount() << " nodes, " << hierarchy.GetEdgeCount() << " edges, "
+				<< hierarchy.GetIndexSize() << " bytes\n";
+
+			finder.PathFinder = std::make_unique<PathFinder::ContractionHierarchyPathFinder>(hierarchy);
+			return true;
+		}
+
+		if (options.FinderName == "parallel")
+		{
+			auto pathFinder = std::make_unique<PathFinder::ParallelAStarPathFinder>(map, options.ThreadCount);
+			pathFinder->SetHasDiagonalMove(options.HasDiagonalMove);
+			std::cerr << "parallel threads: " << pathFinder->GetThreadCount() << "\n";
+			finder.PathFinder = std::move(pathFinder);
+			return true;
+		}
+
+		std::cerr << "unknown finder: " << options.FinderName << "\n";
+		return false;
+	}
+
+	//path is nullptr if not found
+	void appendResult(std::string& output, size_t index, const PathFinder::IPath<Math::Vector2d>* path, double time, bool writePath)
+	{
+		output += std::to_string(index);
+		output += path != nullptr ? " found " : " notfound ";
+		output += std::to_string(path != nullptr ? size_t(path->GetLength()) : 0u);
+		output += ' ';
+		output += std::to_string(size_t(time * 1e6));
+
+		if (path != nullptr && writePath)
+		{
+			path->SetToBegin();
+			while (!path->IsEnd())
+			{
+				const auto position = path->GetCoordinates();
+				output += ' ';
+				output += std::to_string(position.X);
+				output += ',';
+				output += std::to_string(position.Y);
+				path->Next();
+			}
+			path->SetToBegin();
+		}
+		output += '\n';
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	World::Map2d map(0, 0);
+	World::MapFileInfo mapFileInfo;
+	World::ConnectivityLabels labels;
+	Storage::Snapshot snapshot;
+
+	const auto loadBegin = Clock::now();
+	const bool snapshotLoaded = loadSnapshot(options, snapshot, map, mapFileInfo);
+	if (!snapshotLoaded)
+	{
+		snapshot.Close();
+
+		Math::Vector2d beginPosition, endPosition;
+		if (options.MapFileName.empty())
+		{
+			std::cerr << "can not load snapshot: " << options.SnapshotFileName << "\n";
+			return 1;
+		}
+		if (!World::LoadMap(options.MapFileName, map, beginPosition, endPosition) || !World::GetMapFileInfo(options.MapFileName, mapFileInfo))
+		{
+			std::cerr << "can not load map: " << options.MapFileName << "\n";
+			return 1;
+		}
+	}
+
+	//the map of the snapshot is used with any moves, labels only with the same moves
+	if (!snapshotLoaded || !loadLabels(snapshot, map, labels) || labels.HasDiagonalMove() != options.HasDiagonalMove)
+		labels.Build(map, options.HasDiagonalMove);
+
+	std::cerr << (snapshotLoaded ? "snapshot loaded: " : "map loaded: ") << getSeconds(loadBegin, Clock::now()) * 1e3 << " ms, "
+		<< labels.GetComponentCount() << " connected areas";
+	if (snapshotLoaded)
+		std::cerr << ", " << snapshot.GetFileSize() << " bytes";
+	std::cerr << "\n";
+
+	std::vector<Query> queries;
+	if (!loadQueries(options.QueriesFileName, map, queries))
+	{
+		std::cerr << "can not load queries: " << options.QueriesFileName << "\n";
+		return 1;
+	}
+
+	Finder finder;
+	if (!createFinder(options, map, snapshot, finder))
+		return 1;
+
+	std::ofstream outputFile;
+	if (!options.OutputFileName.empty())
+	{
+		outputFile.open(options.OutputFileName, std::ios::out | std::ios::binary);
+		if (!outputFile.is_open())
+		{
+			std::cerr << "can not open output: " << options.OutputFileName << "\n";
+			return 1;
+		}
+	}
+	std::ostream& output = options.OutputFileName.empty() ? std::cout : outputFile;
+
+	std::string buffer;
+	buffer.reserve(OutputBufferSize);
+
+	size_t found = 0u;
+	size_t expanded = 0u;
+	double totalTime = 0.;
+
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		const auto begin = Clock::now();
+		//different connected areas, the search would only exhaust the begin area
+		const bool connected = labels.IsConnected(queries[i].Begin, queries[i].End);
+		const auto result = connected ? finder.PathFinder->FindPath(queries[i].Begin, queries[i].End) : PathFinder::IPathFinderResult::NotFound;
+		const double time = getSeconds(begin, Clock::now());
+
+		totalTime += time;
+		if (result == PathFinder::IPathFinderResult::Found)
+			++found;
+		if (connected && finder.AStarPathFinder != nullptr)
+			expanded += finder.AStarPathFinder->GetExpandedCount();
+
+		appendResult(buffer, i, result == PathFinder::IPathFinderResult::Found ? &finder.PathFinder->GetPath() : nullptr, time, options.WritePaths);
+		if (buffer.size() >= OutputBufferSize)
+		{
+			output.write(buffer.data(), std::streamsize(buffer.size()));
+			buffer.clear();
+		}
+	}
+	output.write(buffer.data(), std::streamsize(buffer.size()));
+	output.flush();
+
+	std::cerr << "queries: " << queries.size() << ", found: " << found
+		<< ", total: " << totalTime * 1e3 << " ms, average: "
+		<< (queries.empty() ? 0. : totalTime / double(queries.size()) * 1e6) << " us";
+	if (finder.AStarPathFinder != nullptr)
+		std::cerr << ", expanded: " << expanded;
+	std::cerr << "\n";
+
+	//after the queries: the loaded snapshot is still mapped while they run, and it is closed before it is replaced
+	if (!options.SnapshotFileName.empty() && !updateSnapshot(options.SnapshotFileName, snapshot, map, mapFileInfo, labels, finder))
+		std::cerr << "can not write snapshot: " << options.SnapshotFileName << "\n";
+
+	return output ? 0 : 1;
+}
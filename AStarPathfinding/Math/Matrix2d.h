@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 #include "Vector2d.h"
@@ -25,11 +26,16 @@ namespace Math
 	public:
 		Matrix2d() = default;
 		Matrix2d(size_t width, size_t height) : m_fields(width* height), m_width(width), m_height(height) {}
+		//fields are width * height values row by row
+		Matrix2d(size_t width, size_t height, const T* fields) : m_fields(fields, fields + width * height), m_width(width), m_height(height) {}
 		Matrix2d(const Matrix2d& matrix) : m_fields(matrix.m_fields), m_width(matrix.m_width), m_height(matrix.m_height) {}
+		Matrix2d& operator=(const Matrix2d& matrix) = default;
 		~Matrix2d() = default;
 
 		size_t GetWidth() const noexcept { return m_width; }
 		size_t GetHeight() const noexcept { return m_height; }
+		//width * height values row by row
+		const T* GetData() const noexcept { return m_fields.data(); }
 
 		T GetField(const Math::Vector2d& position) const noexcept
 		{
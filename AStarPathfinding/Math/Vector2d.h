@@ -1,6 +1,8 @@
 #pragma once
 #include <array>
 #include <cmath>
+#include <functional>
+#include <cstdint>
 
 namespace Math
 {
@@ -42,10 +44,21 @@ namespace Math
 		size_t dX = lhs.X > rhs.X ? lhs.X - rhs.X : rhs.X - lhs.X;
 		size_t dY = lhs.Y > rhs.Y ? lhs.Y - rhs.Y : rhs.Y - lhs.Y;
 
-		size_t dMin = dX > dY ? dX : dY;
+		size_t dMin = dX < dY ? dX : dY;
 		return double(D * (dX + dY)) + (D2 - 2. * D) * double(dMin);
 	}
 
+	//8 way, fixed point: straight and diagonal move costs are integers (10 and 14, 256 and 362 = 256 * sqrt(2))
+	constexpr uint32_t OctileDistance(const Vector2d& lhs, const Vector2d& rhs, uint32_t straightCost, uint32_t diagonalCost)
+	{
+		size_t dX = lhs.X > rhs.X ? lhs.X - rhs.X : rhs.X - lhs.X;
+		size_t dY = lhs.Y > rhs.Y ? lhs.Y - rhs.Y : rhs.Y - lhs.Y;
+
+		size_t dMin = dX < dY ? dX : dY;
+		size_t dMax = dX < dY ? dY : dX;
+		return uint32_t(straightCost * (dMax - dMin) + diagonalCost * dMin);
+	}
+
 	//constexpr
 	inline double EuclideanDistance(const Vector2d& lhs, const Vector2d& rhs)
 	{
@@ -1,54 +1,81 @@
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-#include "AStarPathfinder.h"
+#include "AStarPathFinder.h"
 
 namespace PathFinder
 {
+	namespace
+	{
+		//keys saturate instead of overflowing: a huge epsilon only makes the search greedier
+		int64_t ToKey(double value) noexcept
+		{
+			//2^63, the smallest double above the int64_t range
+			constexpr double KeyLimit = 9223372036854775808.;
+			return value < KeyLimit ? std::llround(value) : std::numeric_limits<int64_t>::max();
+		}
+	}
+
 	IPathFinderResult AStarPathFinder::FindPath(const Math::Vector2d& begin, const Math::Vector2d& end)
 	{
 		if (m_searchDataDirty)
 		{
 			m_searchData.Clear();
 		}
+		m_searchDataDirty = true;
 
 		m_result = IPathFinderResult::NotFound;
 		m_begin = begin;
 		m_end = end;
 
 		m_openList.clear();
+		m_focalList.clear();
+		m_focalBoundKey = std::numeric_limits<int64_t>::min();
+		m_addedCount = 0u;
+		m_expandedCount = 0u;
 		m_path = Path2d();
+		m_droppedEvents.store(0u, std::memory_order_relaxed);
 
 		//temp
 		std::vector<AStarNode> childNodes;
 
-		double hBegin = GetDistance(begin, end);
-		double gBegin = 0.;
-		AStarNode beginNode{ begin, gBegin, hBegin + gBegin };
+		AStarNode beginNode = CreateNode(begin, 0.);
 		NodeData beginNodeData{ Math::Vector2d(), beginNode.fWeight, true, false };
 
-		m_openList.insert(beginNode);
+		PushNode(beginNode);
 		m_searchData.SetField(begin, beginNodeData);
+		PublishEvent(begin, SearchEventType::Opened);
 
-		while (!m_openList.empty())
+		AStarNode node;
+		while (PopNode(node))
 		{
-			//find with smallest f
-			auto it = m_openList.begin();
-			auto node = *it;
-			m_openList.erase(it);
+			auto&& nodeData = m_searchData.GetField(node.Position);
+			//the cell was added again with a smaller weight
+			if (node.fWeight > nodeData.FWeight)
+				continue;
+
+			//the end is checked on expansion, not on adding: only then the weight bound holds
+			if (node.Position == end)
+			{
+				FillPath(node);
+
+				m_result = IPathFinderResult::Found;
+				return m_result;
+			}
+
+			++m_expandedCount;
+			nodeData.InOpenList = false;
+			nodeData.InClosedList = true;
+			m_searchData.SetField(node.Position, nodeData);
+			PublishEvent(node.Position, SearchEventType::Closed);
 
 			childNodes.clear();
 			GetSuccessors(node, childNodes);
 
 			for (auto&& childNode : childNodes)
 			{
-				if (childNode.Position == end)
-				{
-					FillPath(node);
-
-					m_result = IPathFinderResult::Found;
-					return m_result;
-				}
-
 				auto&& childNodeData = m_searchData.GetField(childNode.Position);
 
 				if (childNodeData.InOpenList && childNodeData.FWeight <= childNode.fWeight)
@@ -59,21 +86,122 @@ namespace PathFinder
 				childNodeData.ParentPosition = node.Position;
 				childNodeData.FWeight = childNode.fWeight;
 				childNodeData.InOpenList = true;
-				//nodeData.InClosedList;
+				childNodeData.InClosedList = false;
 
 				m_searchData.SetField(childNode.Position, childNodeData);
-				m_openList.emplace(childNode);
+				PushNode(childNode);
+				PublishEvent(childNode.Position, SearchEventType::Opened);
 			}
-
-			auto&& nodeData = m_searchData.GetField(node.Position);
-			nodeData.InOpenList = false;
-			nodeData.InClosedList = true;
-			m_searchData.SetField(node.Position, nodeData);
 		}
 
 		return m_result;
 	}
 
+	void AStarPathFinder::SetSearchMode(AStarSearchMode mode, double epsilon) noexcept
+	{
+		assert(epsilon >= 0.);
+
+		m_searchMode = mode;
+		if (mode == AStarSearchMode::Optimal || !(epsilon > 0.))
+			m_epsilon = 0.;
+		else
+			m_epsilon = epsilon < MaxEpsilon ? epsilon : MaxEpsilon;
+	}
+
+	AStarPathFinder::AStarNode AStarPathFinder::CreateNode(const Math::Vector2d& position, double gWeight) noexcept
+	{
+		//keys are compared instead of weights, float errors are far below the resolution
+		constexpr double KeyResolution = 1e-6;
+
+		AStarNode node;
+		node.Position = position;
+		node.hWeight = GetDistance(position, m_end);
+		node.gWeight = gWeight;
+		node.fWeight = gWeight + (m_searchMode == AStarSearchMode::Weighted ? 1. + m_epsilon : 1.) * node.hWeight;
+		node.fKey = ToKey(node.fWeight / KeyResolution);
+		node.hKey = ToKey(node.hWeight / KeyResolution);
+
+		switch (m_tieBreaking)
+		{
+		case AStarTieBreaking::Fifo:
+			node.Order = m_addedCount;
+			break;
+		case AStarTieBreaking::Lifo:
+			node.Order = ~m_addedCount;
+			break;
+		case AStarTieBreaking::LargerG:
+			node.TieBreak = -gWeight;
+			node.Order = m_addedCount;
+			break;
+		case AStarTieBreaking::CrossProduct:
+		{
+			const double dX1 = double(position.X) - double(m_end.X);
+			const double dY1 = double(position.Y) - double(m_end.Y);
+			const double dX2 = double(m_begin.X) - double(m_end.X);
+			const double dY2 = double(m_begin.Y) - double(m_end.Y);
+			node.TieBreak = std::abs(dX1 * dY2 - dX2 * dY1);
+			node.Order = m_addedCount;
+			break;
+		}
+		}
+		++m_addedCount;
+
+		return node;
+	}
+
+	void AStarPathFinder::PushNode(const AStarNode& node)
+	{
+		auto it = m_openList.insert(node);
+
+		if (m_searchMode == AStarSearchMode::Focal && it->fKey <= m_focalBoundKey)
+			m_focalList.insert(it);
+	}
+
+	bool AStarPathFinder::PopNode(AStarNode& node)
+	{
+		if (m_openList.empty())
+			return false;
+
+		if (m_searchMode != AStarSearchMode::Focal)
+		{
+			//find with smallest f
+			auto it = m_openList.begin();
+			node = *it;
+			m_openList.erase(it);
+			return true;
+		}
+
+		//min f never decreases with a consistent heuristic, so the focal list only grows at its bound
+		const int64_t minKey = m_openList.begin()->fKey;
+		//double keeps 53 bits, the bound is never below the key it is computed from
+		const int64_t boundKey = std::max(minKey, ToKey(double(minKey) * (1. + m_epsilon)));
+		if (boundKey > m_focalBoundKey)
+		{
+			AStarNode lastFocal;
+			lastFocal.fKey = m_focalBoundKey;
+			lastFocal.TieBreak = std::numeric_limits<double>::infinity();
+			lastFocal.Order = std::numeric_limits<uint64_t>::max();
+
+			AStarNode newLastFocal = lastFocal;
+			newLastFocal.fKey = boundKey;
+
+			const auto last = m_openList.upper_bound(newLastFocal);
+			for (auto it = m_openList.upper_bound(lastFocal); it != last; ++it)
+			{
+				m_focalList.insert(it);
+			}
+			m_focalBoundKey = boundKey;
+		}
+
+		assert(!m_focalList.empty());
+		auto focalIt = m_focalList.begin();
+		const auto it = *focalIt;
+		node = *it;
+		m_focalList.erase(focalIt);
+		m_openList.erase(it);
+		return true;
+	}
+
 	std::vector<Math::Vector2d> AStarPathFinder::GetClosedList() const
 	{
 		std::vector<Math::Vector2d> result;
@@ -108,7 +236,7 @@ namespace PathFinder
 		return result;
 	}
 
-	void AStarPathFinder::GetSuccessors(const AStarNode& node, std::vector<AStarNode>& result) const noexcept
+	void AStarPathFinder::GetSuccessors(const AStarNode& node, std::vector<AStarNode>& result) noexcept
 	{
 		if (m_hasDiagonalMove)
 		{
@@ -117,12 +245,7 @@ namespace PathFinder
 			for (auto&& position : positions)
 			{
 				if (m_map.IsInside(position) && m_map.GetField(position) != World::FieldType::Obstacle)
-				{
-					double hWeight = GetDistance(position, m_end);
-					double gWeight = node.gWeight + GetDistance(position, node.Position);
-
-					result.emplace_back(AStarNode{ position, gWeight, hWeight + gWeight });
-				}
+					result.emplace_back(CreateNode(position, node.gWeight + GetDistance(position, node.Position)));
 			}
 		}
 		else
@@ -132,12 +255,7 @@ namespace PathFinder
 			for (auto&& position : positions)
 			{
 				if (m_map.IsInside(position) && m_map.GetField(position) != World::FieldType::Obstacle)
-				{
-					double hWeight = GetDistance(position, m_end);
-					double gWeight = node.gWeight + GetDistance(position, node.Position);
-
-					result.emplace_back(AStarNode{ position, gWeight, hWeight + gWeight });
-				}
+					result.emplace_back(CreateNode(position, node.gWeight + GetDistance(position, node.Position)));
 			}
 		}
 	}
@@ -148,8 +266,6 @@ namespace PathFinder
 		std::vector<Math::Vector2d> path;
 		path.reserve(length);
 
-		path.emplace_back(m_end);
-
 		auto currentPosition = node.Position;
 
 		while (currentPosition != m_begin)
@@ -163,6 +279,15 @@ namespace PathFinder
 	}
 	double AStarPathFinder::GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept
 	{
-		return m_hasDiagonalMove ? Math::EuclideanDistance(lhs, rhs) : double(Math::ManhattanDistance(lhs, rhs));
+		//octile distance: exact for moves between neighbours and a closer heuristic than euclidean, without sqrt
+		return m_hasDiagonalMove ? Math::DiagonalDistance(lhs, rhs) : double(Math::ManhattanDistance(lhs, rhs));
+	}
+	void AStarPathFinder::PublishEvent(const Math::Vector2d& position, SearchEventType type)
+	{
+		if (m_events == nullptr)
+			return;
+
+		if (!m_events->TryPush(SearchEvent{ position, type }))
+			m_droppedEvents.fetch_add(1u, std::memory_order_relaxed);
 	}
 }
@@ -2,31 +2,66 @@
 #include <vector>
 #include <unordered_map>
 #include <set>
+#include <atomic>
+#include <cstdint>
 
 #include "IPathFinder.h"
 #include "Path2d.h"
+#include "SearchEvent.h"
 
-#include "..\World\Map2d.h"
-#include "..\Math\Vector2d.h"
-#include "..\Math\Matrix2d.h"
+#include "../World/Map2d.h"
+#include "../Math/Vector2d.h"
+#include "../Math/Matrix2d.h"
 
 namespace PathFinder
 {
+	//Выбор среди вершин открытого списка с равным f
+	enum class AStarTieBreaking : unsigned char
+	{
+		//the first added
+		Fifo,
+		//the last added
+		Lifo,
+		//larger g, i.e. closer to the end
+		LargerG,
+		//closer to the straight line from the begin to the end
+		CrossProduct,
+	};
+
+	enum class AStarSearchMode : unsigned char
+	{
+		Optimal,
+		//weighted A*: f = g + (1 + epsilon) * h
+		Weighted,
+		//focal search: among open nodes with f <= (1 + epsilon) * min f the closest to the end is expanded
+		Focal,
+	};
+
 	namespace details
 	{
 		struct AStarNode final
 		{
 			Math::Vector2d Position;
 
-			//double hWeight = 0.;
+			double hWeight = 0.;
 			double gWeight = 0.;
 			double fWeight = 0.;
+
+			//keys of the open list: f and h are rounded, so equal weights with different float errors tie
+			int64_t fKey = 0;
+			int64_t hKey = 0;
+			double TieBreak = 0.;
+			uint64_t Order = 0u;
 		};
 
 		constexpr bool operator < (const AStarNode& lhs, const AStarNode& rhs)
 		{
 			//We need to overload "<" to put our struct into a set
-			return lhs.fWeight < rhs.fWeight;
+			if (lhs.fKey != rhs.fKey)
+				return lhs.fKey < rhs.fKey;
+			if (lhs.TieBreak != rhs.TieBreak)
+				return lhs.TieBreak < rhs.TieBreak;
+			return lhs.Order < rhs.Order;
 		}
 
 	}
@@ -37,6 +72,9 @@ namespace PathFinder
 		using AStarNode = details::AStarNode;
 
 	public:
+		//larger epsilon is clamped: (1 + epsilon) * key of a unit weight stays in the int64_t range
+		static constexpr double MaxEpsilon = 1e12;
+
 		AStarPathFinder() = delete;
 		AStarPathFinder(const World::Map2d& map) : m_map(map), m_searchData(map.GetWidth(), map.GetHeight()){}
 		~AStarPathFinder() override = default;
@@ -45,11 +83,28 @@ namespace PathFinder
 		IPathFinderResult GetResult() const noexcept override { return m_result; }
 		const IPath<Math::Vector2d>& GetPath() const noexcept override { return m_path; }
 
+		//full scan of the search data, not safe while FindPath is running
 		std::vector<Math::Vector2d> GetClosedList() const;
 		std::vector<Math::Vector2d> GetOpenList() const;
 
+		//FindPath publishes open/closed list changes to the events (the finder is the only producer).
+		//Events are dropped when the buffer is full, the search never waits for the consumer
+		void SetSearchEvents(SearchEventBuffer* events) noexcept { m_events = events; }
+		size_t GetDroppedEventCount() const noexcept { return m_droppedEvents.load(std::memory_order_relaxed); }
+
 		//todo IMapWalker
 		void SetHasDiagonalMove(bool has) noexcept { m_hasDiagonalMove = has; }
+
+		void SetTieBreaking(AStarTieBreaking tieBreaking) noexcept { m_tieBreaking = tieBreaking; }
+		AStarTieBreaking GetTieBreaking() const noexcept { return m_tieBreaking; }
+
+		//path weight is at most (1 + epsilon) * optimal weight, epsilon is ignored by the optimal mode and clamped to MaxEpsilon
+		void SetSearchMode(AStarSearchMode mode, double epsilon = 0.) noexcept;
+		AStarSearchMode GetSearchMode() const noexcept { return m_searchMode; }
+		double GetEpsilon() const noexcept { return m_epsilon; }
+
+		//nodes expanded by the last FindPath
+		size_t GetExpandedCount() const noexcept { return m_expandedCount; }
 	private:
 		const World::IMap<Math::Vector2d>& m_map;
 
@@ -65,7 +120,28 @@ namespace PathFinder
 		Math::Matrix2d<NodeData> m_searchData;
 		bool m_searchDataDirty = false;
 
-		std::multiset<AStarNode> m_openList;
+		using OpenList = std::multiset<AStarNode>;
+
+		struct FocalCompare final
+		{
+			bool operator()(OpenList::const_iterator lhs, OpenList::const_iterator rhs) const noexcept
+			{
+				if (lhs->hKey != rhs->hKey)
+					return lhs->hKey < rhs->hKey;
+				if (lhs->TieBreak != rhs->TieBreak)
+					return lhs->TieBreak < rhs->TieBreak;
+				return lhs->Order < rhs->Order;
+			}
+		};
+
+		OpenList m_openList;
+		//focal mode: open nodes with fKey <= m_focalBoundKey
+		std::multiset<OpenList::const_iterator, FocalCompare> m_focalList;
+		int64_t m_focalBoundKey = 0;
+
+		uint64_t m_addedCount = 0u;
+		size_t m_expandedCount = 0u;
+
 		Path2d m_path;
 
 		Math::Vector2d m_begin;
@@ -74,9 +150,20 @@ namespace PathFinder
 		IPathFinderResult m_result = IPathFinderResult::NotFound;
 		bool m_hasDiagonalMove = true;
 
-		void GetSuccessors(const AStarNode& node, std::vector<AStarNode>& result) const noexcept;
+		AStarTieBreaking m_tieBreaking = AStarTieBreaking::Fifo;
+		AStarSearchMode m_searchMode = AStarSearchMode::Optimal;
+		double m_epsilon = 0.;
+
+		SearchEventBuffer* m_events = nullptr;
+		std::atomic<size_t> m_droppedEvents{ 0u };
+
+		AStarNode CreateNode(const Math::Vector2d& position, double gWeight) noexcept;
+		void PushNode(const AStarNode& node);
+		bool PopNode(AStarNode& node);
+		void GetSuccessors(const AStarNode& node, std::vector<AStarNode>& result) noexcept;
 		void FillPath(const AStarNode& node);
 		double GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept;
+		void PublishEvent(const Math::Vector2d& position, SearchEventType type);
 
 	};
 }
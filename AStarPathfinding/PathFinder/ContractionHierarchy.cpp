@@ -0,0 +1,507 @@
+#include <queue>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <utility>
+
+#include "ContractionHierarchy.h"
+
+namespace PathFinder
+{
+	constexpr uint32_t ContractionHierarchy::InvalidNode;
+
+	namespace
+	{
+		constexpr uint32_t FileMagic = 0x48435041u;//"APCH"
+		constexpr uint32_t FileVersion = 1u;
+
+		constexpr double Epsilon = 1e-9;
+		//witness searches are cut off, a missed witness only adds a redundant shortcut
+		constexpr size_t SimulationSettledLimit = 32u;
+		constexpr size_t ContractionSettledLimit = 512u;
+
+		using Edge = details::ContractionHierarchyEdge;
+		using QueueItem = std::pair<double, uint32_t>;
+		using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+		struct Shortcut final
+		{
+			uint32_t From;
+			uint32_t To;
+			double Weight;
+		};
+
+		class ContractionBuilder final
+		{
+		public:
+			explicit ContractionBuilder(std::vector<std::vector<Edge>>&& edges) :
+				m_edges(std::move(edges)),
+				m_upwardEdges(m_edges.size()),
+				m_deletedNeighbours(m_edges.size(), 0u),
+				m_level(m_edges.size(), 0u),
+				m_distance(m_edges.size(), std::numeric_limits<double>::infinity())
+			{
+			}
+
+			std::vector<std::vector<Edge>> Contract()
+			{
+				const uint32_t nodeCount = uint32_t(m_edges.size());
+
+				MinQueue queue;
+				for (uint32_t node = 0; node < nodeCount; ++node)
+				{
+					queue.emplace(GetPriority(node), node);
+				}
+
+				while (!queue.empty())
+				{
+					const uint32_t node = queue.top().second;
+					queue.pop();
+
+					//lazy update: priorities of neighbours of contracted nodes are stale
+					const double priority = GetPriority(node);
+					if (!queue.empty() && priority > queue.top().first)
+					{
+						queue.emplace(priority, node);
+						continue;
+					}
+
+					FindShortcuts(node, ContractionSettledLimit);
+					ContractNode(node);
+				}
+
+				return std::move(m_upwardEdges);
+			}
+
+		private:
+			std::vector<std::vector<Edge>> m_edges;
+			std::vector<std::vector<Edge>> m_upwardEdges;
+			std::vector<uint32_t> m_deletedNeighbours;
+			std::vector<uint32_t> m_level;
+
+			//witness search
+			std::vector<double> m_distance;
+			std::vector<uint32_t> m_touched;
+			std::vector<QueueItem> m_queue;
+			std::vector<Shortcut> m_shortcuts;
+
+			double GetPriority(uint32_t node)
+			{
+				FindShortcuts(node, SimulationSettledLimit);
+
+				const double edgeDifference = double(m_shortcuts.size()) - double(m_edges[node].size());
+				return 2. * edgeDifference + double(m_deletedNeighbours[node]) + double(m_level[node]);
+			}
+
+			void FindShortcuts(uint32_t node, size_t settledLimit)
+			{
+				m_shortcuts.clear();
+
+				const auto& edges = m_edges[node];
+				for (size_t i = 0; i < edges.size(); ++i)
+				{
+					double maxWeight = 0.;
+					for (size_t j = i + 1; j < edges.size(); ++j)
+					{
+						maxWeight = std::max(maxWeight, edges[j].Weight);
+					}
+					if (maxWeight == 0.)
+						continue;
+
+					WitnessSearch(edges[i].Target, node, edges[i].Weight + maxWeight, settledLimit);
+
+					for (size_t j = i + 1; j < edges.size(); ++j)
+					{
+						const double weight = edges[i].Weight + edges[j].Weight;
+						if (m_distance[edges[j].Target] > weight + Epsilon)
+							m_shortcuts.emplace_back(Shortcut{ edges[i].Target, edges[j].Target, weight });
+					}
+
+					for (auto touched : m_touched)
+					{
+						m_distance[touched] = std::numeric_limits<double>::infinity();
+					}
+					m_touched.clear();
+				}
+			}
+
+			void WitnessSearch(uint32_t source, uint32_t excluded, double maxWeight, size_t settledLimit)
+			{
+				m_queue.clear();
+				auto push = [this](double weight, uint32_t node)
+				{
+					m_queue.emplace_back(weight, node);
+					std::push_heap(std::begin(m_queue), std::end(m_queue), std::greater<QueueItem>());
+				};
+
+				m_distance[source] = 0.;
+				m_touched.emplace_back(source);
+				push(0., source);
+
+				size_t settled = 0u;
+				while (!m_queue.empty() && settled < settledLimit)
+				{
+					std::pop_heap(std::begin(m_queue), std::end(m_queue), std::greater<QueueItem>());
+					const auto item = m_queue.back();
+					m_queue.pop_back();
+
+					if (item.first > m_distance[item.second])
+						continue;
+					if (item.first > maxWeight)
+						break;
+					++settled;
+
+					for (auto&& edge : m_edges[item.second])
+					{
+						if (edge.Target == excluded)
+							continue;
+
+						const double weight = item.first + edge.Weight;
+						double& distance = m_distance[edge.Target];
+						if (weight < distance)
+						{
+							if (distance == std::numeric_limits<double>::infinity())
+								m_touched.emplace_back(edge.Target);
+							distance = weight;
+							push(weight, edge.Target);
+						}
+					}
+				}
+			}
+
+			void AddEdge(uint32_t from, uint32_t to, uint32_t middle, double weight)
+			{
+				auto& edges = m_edges[from];
+				auto it = std::find_if(std::begin(edges), std::end(edges), [to](const Edge& edge) { return edge.Target == to; });
+
+				if (it == std::end(edges))
+				{
+					edges.emplace_back(Edge{ to, middle, weight });
+				}
+				else if (weight < it->Weight)
+				{
+					it->Middle = middle;
+					it->Weight = weight;
+				}
+			}
+
+			void ContractNode(uint32_t node)
+			{
+				for (auto&& shortcut : m_shortcuts)
+				{
+					AddEdge(shortcut.From, shortcut.To, node, shortcut.Weight);
+					AddEdge(shortcut.To, shortcut.From, node, shortcut.Weight);
+				}
+
+				for (auto&& edge : m_edges[node])
+				{
+					auto& neighbourEdges = m_edges[edge.Target];
+					neighbourEdges.erase(std::remove_if(std::begin(neighbourEdges), std::end(neighbourEdges),
+						[node](const Edge& neighbourEdge) { return neighbourEdge.Target == node; }), std::end(neighbourEdges));
+
+					++m_deletedNeighbours[edge.Target];
+					m_level[edge.Target] = std::max(m_level[edge.Target], m_level[node] + 1u);
+				}
+
+				//all remaining neighbours are contracted later, so they have higher rank
+				m_upwardEdges[node] = std::move(m_edges[node]);
+				m_edges[node] = std::vector<Edge>();
+			}
+		};
+
+		struct HierarchySnapshotHeader final
+		{
+			uint64_t Width = 0u;
+			uint64_t Height = 0u;
+			uint32_t HasDiagonalMove = 0u;
+			uint32_t Reserved = 0u;
+		};
+
+		template<typename T>
+		void WriteArray(std::ofstream& output, Storage::ArrayView<T> array)
+		{
+			const uint64_t size = array.GetSize();
+			output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			output.write(reinterpret_cast<const char*>(array.GetData()), std::streamsize(sizeof(T) * array.GetSize()));
+		}
+
+		template<typename T>
+		bool ReadArray(std::ifstream& input, std::vector<T>& array)
+		{
+			uint64_t size = 0u;
+			if (!input.read(reinterpret_cast<char*>(&size), sizeof(size)))
+				return false;
+
+			//a corrupt size must not allocate more than the rest of the file
+			const auto position = input.tellg();
+			input.seekg(0, std::ios::end);
+			const auto fileEnd = input.tellg();
+			input.seekg(position);
+			if (position < 0 || fileEnd < position || size > uint64_t(fileEnd - position) / sizeof(T))
+				return false;
+
+			array.resize(size_t(size));
+			return bool(input.read(reinterpret_cast<char*>(array.data()), std::streamsize(sizeof(T) * array.size())));
+		}
+	}
+
+	void ContractionHierarchy::Build(const World::Map2d& map, bool hasDiagonalMove)
+	{
+		m_width = map.GetWidth();
+		m_height = map.GetHeight();
+		m_hasDiagonalMove = hasDiagonalMove;
+
+		m_cellToNodeStorage.assign(m_width * m_height, InvalidNode);
+		m_nodeToCellStorage.clear();
+
+		for (size_t x = 0; x < m_height; ++x)
+		{
+			for (size_t y = 0; y < m_width; ++y)
+			{
+				Math::Vector2d position{ x, y };
+				if (map.GetField(position) == World::FieldType::Obstacle)
+					continue;
+
+				m_cellToNodeStorage[x * m_width + y] = uint32_t(m_nodeToCellStorage.size());
+				m_nodeToCellStorage.emplace_back(uint32_t(x * m_width + y));
+			}
+		}
+		m_firstEdgeStorage.clear();
+		m_edgesStorage.clear();
+		UseStorage();
+
+		std::vector<std::vector<Edge>> edges(GetNodeCount());
+		for (uint32_t node = 0; node < uint32_t(GetNodeCount()); ++node)
+		{
+			const auto position = GetPosition(node);
+			auto addEdge = [&](const Math::Vector2d& neighbour)
+			{
+				const uint32_t target = GetNode(neighbour);
+				if (target != InvalidNode)
+					edges[node].emplace_back(Edge{ target, InvalidNode, Math::EuclideanDistance(position, neighbour) });
+			};
+
+			if (m_hasDiagonalMove)
+			{
+				for (auto&& neighbour : Math::GetNeighours8way(position))
+					addEdge(neighbour);
+			}
+			else
+			{
+				for (auto&& neighbour : Math::GetNeighours4way(position))
+					addEdge(neighbour);
+			}
+		}
+
+		const auto upwardEdges = ContractionBuilder(std::move(edges)).Contract();
+
+		m_firstEdgeStorage.assign(upwardEdges.size() + 1, 0u);
+		for (size_t node = 0; node < upwardEdges.size(); ++node)
+		{
+			m_firstEdgeStorage[node] = uint32_t(m_edgesStorage.size());
+			m_edgesStorage.insert(std::end(m_edgesStorage), std::begin(upwardEdges[node]), std::end(upwardEdges[node]));
+		}
+		m_firstEdgeStorage[upwardEdges.size()] = uint32_t(m_edgesStorage.size());
+		UseStorage();
+	}
+
+	bool ContractionHierarchy::Save(const std::string& fileName) const
+	{
+		std::ofstream output(fileName, std::ios::out | std::ios::binary);
+		if (!output.is_open())
+			return false;
+
+		const uint64_t width = m_width;
+		const uint64_t height = m_height;
+		const uint32_t hasDiagonalMove = m_hasDiagonalMove ? 1u : 0u;
+
+		output.write(reinterpret_cast<const char*>(&FileMagic), sizeof(FileMagic));
+		output.write(reinterpret_cast<const char*>(&FileVersion), sizeof(FileVersion));
+		output.write(reinterpret_cast<const char*>(&width), sizeof(width));
+		output.write(reinterpret_cast<const char*>(&height), sizeof(height));
+		output.write(reinterpret_cast<const char*>(&hasDiagonalMove), sizeof(hasDiagonalMove));
+
+		WriteArray(output, m_cellToNode);
+		WriteArray(output, m_nodeToCell);
+		WriteArray(output, m_firstEdge);
+		WriteArray(output, m_edges);
+
+		return bool(output);
+	}
+
+	bool ContractionHierarchy::Load(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::in | std::ios::binary);
+		if (!input.is_open())
+			return false;
+
+		uint32_t magic = 0u, version = 0u, hasDiagonalMove = 0u;
+		uint64_t width = 0u, height = 0u;
+
+		input.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		input.read(reinterpret_cast<char*>(&version), sizeof(version));
+		input.read(reinterpret_cast<char*>(&width), sizeof(width));
+		input.read(reinterpret_cast<char*>(&height), sizeof(height));
+		input.read(reinterpret_cast<char*>(&hasDiagonalMove), sizeof(hasDiagonalMove));
+
+		if (!input || magic != FileMagic || version != FileVersion)
+			return false;
+
+		//read aside, the views of this hierarchy must not see a partially read index
+		ContractionHierarchy loaded;
+		if (!ReadArray(input, loaded.m_cellToNodeStorage) || !ReadArray(input, loaded.m_nodeToCellStorage) ||
+			!ReadArray(input, loaded.m_firstEdgeStorage) || !ReadArray(input, loaded.m_edgesStorage))
+			return false;
+
+		loaded.m_width = size_t(width);
+		loaded.m_height = size_t(height);
+		loaded.m_hasDiagonalMove = hasDiagonalMove != 0u;
+		loaded.UseStorage();
+		if (!loaded.IsValid())
+			return false;
+
+		Swap(loaded);
+		return true;
+	}
+
+	bool ContractionHierarchy::AddToSnapshot(Storage::SnapshotWriter& writer) const
+	{
+		HierarchySnapshotHeader header;
+		header.Width = m_width;
+		header.Height = m_height;
+		header.HasDiagonalMove = m_hasDiagonalMove ? 1u : 0u;
+
+		return writer.AddValue(Storage::SnapshotSection::HierarchyHeader, header) &&
+			writer.AddArray(Storage::SnapshotSection::HierarchyCellToNode, m_cellToNode) &&
+			writer.AddArray(Storage::SnapshotSection::HierarchyNodeToCell, m_nodeToCell) &&
+			writer.AddArray(Storage::SnapshotSection::HierarchyFirstEdge, m_firstEdge) &&
+			writer.AddArray(Storage::SnapshotSection::HierarchyEdges, m_edges);
+	}
+
+	bool ContractionHierarchy::Load(const Storage::Snapshot& snapshot)
+	{
+		ContractionHierarchy loaded;
+		HierarchySnapshotHeader header;
+		if (!snapshot.GetValue(Storage::SnapshotSection::HierarchyHeader, header) ||
+			!snapshot.GetArray(Storage::SnapshotSection::HierarchyCellToNode, loaded.m_cellToNode) ||
+			!snapshot.GetArray(Storage::SnapshotSection::HierarchyNodeToCell, loaded.m_nodeToCell) ||
+			!snapshot.GetArray(Storage::SnapshotSection::HierarchyFirstEdge, loaded.m_firstEdge) ||
+			!snapshot.GetArray(Storage::SnapshotSection::HierarchyEdges, loaded.m_edges))
+			return false;
+
+		loaded.m_width = size_t(header.Width);
+		loaded.m_height = size_t(header.Height);
+		loaded.m_hasDiagonalMove = header.HasDiagonalMove != 0u;
+		if (!loaded.IsValid())
+			return false;
+
+		//the storage of this hierarchy is released with loaded
+		Swap(loaded);
+		return true;
+	}
+
+	size_t ContractionHierarchy::GetIndexSize() const noexcept
+	{
+		return sizeof(uint32_t) * (m_cellToNode.GetSize() + m_nodeToCell.GetSize() + m_firstEdge.GetSize()) +
+			sizeof(Edge) * m_edges.GetSize();
+	}
+
+	void ContractionHierarchy::UseStorage() noexcept
+	{
+		m_cellToNode = Storage::ArrayView<uint32_t>(m_cellToNodeStorage);
+		m_nodeToCell = Storage::ArrayView<uint32_t>(m_nodeToCellStorage);
+		m_firstEdge = Storage::ArrayView<uint32_t>(m_firstEdgeStorage);
+		m_edges = Storage::ArrayView<Edge>(m_edgesStorage);
+	}
+
+	void ContractionHierarchy::Swap(ContractionHierarchy& other) noexcept
+	{
+		std::swap(m_width, other.m_width);
+		std::swap(m_height, other.m_height);
+		std::swap(m_hasDiagonalMove, other.m_hasDiagonalMove);
+
+		std::swap(m_cellToNode, other.m_cellToNode);
+		std::swap(m_nodeToCell, other.m_nodeToCell);
+		std::swap(m_firstEdge, other.m_firstEdge);
+		std::swap(m_edges, other.m_edges);
+
+		m_cellToNodeStorage.swap(other.m_cellToNodeStorage);
+		m_nodeToCellStorage.swap(other.m_nodeToCellStorage);
+		m_firstEdgeStorage.swap(other.m_firstEdgeStorage);
+		m_edgesStorage.swap(other.m_edgesStorage);
+	}
+
+	bool ContractionHierarchy::IsValid() const noexcept
+	{
+		//queries do not check indices, so everything they read is checked once here
+		if (m_height != 0u && m_width > std::numeric_limits<uint32_t>::max() / m_height)
+			return false;
+
+		const size_t cellCount = m_width * m_height;
+		const size_t nodeCount = m_nodeToCell.GetSize();
+		if (m_cellToNode.GetSize() != cellCount || nodeCount >= InvalidNode || m_firstEdge.GetSize() != nodeCount + 1)
+			return false;
+
+		for (size_t cell = 0; cell < cellCount; ++cell)
+		{
+			const uint32_t node = m_cellToNode[cell];
+			if (node != InvalidNode && (node >= nodeCount || m_nodeToCell[node] != cell))
+				return false;
+		}
+		for (size_t node = 0; node < nodeCount; ++node)
+		{
+			const uint32_t cell = m_nodeToCell[node];
+			if (cell >= cellCount || m_cellToNode[cell] != node)
+				return false;
+		}
+
+		if (m_firstEdge[0] != 0u || m_firstEdge[nodeCount] != m_edges.GetSize())
+			return false;
+		for (size_t node = 0; node < nodeCount; ++node)
+		{
+			if (m_firstEdge[node] > m_firstEdge[node + 1])
+				return false;
+		}
+
+		for (auto&& edge : m_edges)
+		{
+			if (edge.Target >= nodeCount || (edge.Middle != InvalidNode && edge.Middle >= nodeCount) ||
+				!(edge.Weight > 0. && edge.Weight < std::numeric_limits<double>::infinity()))
+				return false;
+		}
+
+		//a shortcut is unpacked into two edges through its middle, they must exist and add up to its weight
+		for (uint32_t node = 0; node < uint32_t(nodeCount); ++node)
+		{
+			for (auto edge = EdgesBegin(node); edge != EdgesEnd(node); ++edge)
+			{
+				if (edge->Target == node)
+					return false;
+				if (edge->Middle == InvalidNode)
+					continue;
+				if (edge->Middle == node || edge->Middle == edge->Target)
+					return false;
+
+				const Edge* first = FindEdge(node, edge->Middle);
+				const Edge* second = FindEdge(edge->Middle, edge->Target);
+				if (first == nullptr || second == nullptr || std::abs(first->Weight + second->Weight - edge->Weight) > Epsilon * edge->Weight)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	const ContractionHierarchy::Edge* ContractionHierarchy::FindEdge(uint32_t lhs, uint32_t rhs) const noexcept
+	{
+		//the edge is stored only at its lower ranked end
+		auto it = std::find_if(EdgesBegin(lhs), EdgesEnd(lhs), [rhs](const Edge& edge) { return edge.Target == rhs; });
+		if (it != EdgesEnd(lhs))
+			return it;
+
+		it = std::find_if(EdgesBegin(rhs), EdgesEnd(rhs), [lhs](const Edge& edge) { return edge.Target == lhs; });
+		return it != EdgesEnd(rhs) ? it : nullptr;
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "../World/Map2d.h"
+#include "../Math/Vector2d.h"
+#include "../Storage/ArrayView.h"
+#include "../Storage/Snapshot.h"
+
+namespace PathFinder
+{
+	namespace details
+	{
+		struct ContractionHierarchyEdge final
+		{
+			uint32_t Target = 0u;
+			//contracted node of shortcut, InvalidNode for original edge
+			uint32_t Middle = 0u;
+			double Weight = 0.;
+		};
+	}
+
+	/// <summary>
+	/// Иерархия сжатий (Contraction Hierarchies) над свободными клетками Map2d.
+	///
+	/// Строится один раз для статичной карты, хранит только рёбра "вверх" по рангу:
+	/// граф клеток неориентированный, поэтому обе стороны двунаправленного поиска
+	/// используют один и тот же набор рёбер.
+	/// </summary>
+	class ContractionHierarchy final
+	{
+	public:
+		using Edge = details::ContractionHierarchyEdge;
+
+		static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+		ContractionHierarchy() = default;
+		ContractionHierarchy(const ContractionHierarchy&) = delete;
+		ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+		~ContractionHierarchy() = default;
+
+		void Build(const World::Map2d& map, bool hasDiagonalMove);
+
+		bool Save(const std::string& fileName) const;
+		//the hierarchy is unchanged if the load fails
+		bool Load(const std::string& fileName);
+
+		bool AddToSnapshot(Storage::SnapshotWriter& writer) const;
+		//arrays are used in place, the snapshot must outlive the hierarchy; unchanged if the load fails
+		bool Load(const Storage::Snapshot& snapshot);
+
+		size_t GetWidth() const noexcept { return m_width; }
+		size_t GetHeight() const noexcept { return m_height; }
+		bool HasDiagonalMove() const noexcept { return m_hasDiagonalMove; }
+
+		size_t GetNodeCount() const noexcept { return m_nodeToCell.GetSize(); }
+		size_t GetEdgeCount() const noexcept { return m_edges.GetSize(); }
+		//bytes used by the index, the same amount is written by Save
+		size_t GetIndexSize() const noexcept;
+
+		uint32_t GetNode(const Math::Vector2d& position) const noexcept
+		{
+			if (position.X >= m_height || position.Y >= m_width)
+				return InvalidNode;
+			return m_cellToNode[position.X * m_width + position.Y];
+		}
+		Math::Vector2d GetPosition(uint32_t node) const noexcept
+		{
+			const size_t cell = m_nodeToCell[node];
+			return Math::Vector2d{ cell / m_width, cell % m_width };
+		}
+
+		const Edge* EdgesBegin(uint32_t node) const noexcept { return m_edges.GetData() + m_firstEdge[node]; }
+		const Edge* EdgesEnd(uint32_t node) const noexcept { return m_edges.GetData() + m_firstEdge[node + 1]; }
+
+		//edge between lhs and rhs, stored at either end; nullptr if there is none
+		const Edge* FindEdge(uint32_t lhs, uint32_t rhs) const noexcept;
+
+	private:
+		size_t m_width = 0u;
+		size_t m_height = 0u;
+		bool m_hasDiagonalMove = true;
+
+		//views of the storage below or of the snapshot sections
+		Storage::ArrayView<uint32_t> m_cellToNode;
+		Storage::ArrayView<uint32_t> m_nodeToCell;
+
+		//upward edges in CSR layout: edges of node are [m_firstEdge[node]; m_firstEdge[node + 1])
+		Storage::ArrayView<uint32_t> m_firstEdge;
+		Storage::ArrayView<Edge> m_edges;
+
+		//empty when the hierarchy comes from a snapshot
+		std::vector<uint32_t> m_cellToNodeStorage;
+		std::vector<uint32_t> m_nodeToCellStorage;
+		std::vector<uint32_t> m_firstEdgeStorage;
+		std::vector<Edge> m_edgesStorage;
+
+		void UseStorage() noexcept;
+		bool IsValid() const noexcept;
+		//views stay valid: swapped vectors keep their buffers
+		void Swap(ContractionHierarchy& other) noexcept;
+	};
+}
@@ -0,0 +1,175 @@
+#include <cassert>
+#include <limits>
+#include <algorithm>
+
+#include "ContractionHierarchyPathFinder.h"
+
+namespace PathFinder
+{
+	ContractionHierarchyPathFinder::ContractionHierarchyPathFinder(const ContractionHierarchy& hierarchy) :
+		m_hierarchy(hierarchy),
+		m_forwardData(hierarchy.GetNodeCount()),
+		m_backwardData(hierarchy.GetNodeCount())
+	{
+	}
+
+	IPathFinderResult ContractionHierarchyPathFinder::FindPath(const Math::Vector2d& begin, const Math::Vector2d& end)
+	{
+		m_result = IPathFinderResult::NotFound;
+		m_path = Path2d();
+		m_pathWeight = 0.;
+
+		const uint32_t beginNode = m_hierarchy.GetNode(begin);
+		const uint32_t endNode = m_hierarchy.GetNode(end);
+		if (beginNode == ContractionHierarchy::InvalidNode || endNode == ContractionHierarchy::InvalidNode)
+			return m_result;
+
+		//the hierarchy may have been rebuilt or loaded since the last search
+		if (m_forwardData.size() != m_hierarchy.GetNodeCount())
+		{
+			m_forwardData.assign(m_hierarchy.GetNodeCount(), NodeData());
+			m_backwardData.assign(m_hierarchy.GetNodeCount(), NodeData());
+			m_searchId = 0u;
+		}
+		++m_searchId;
+
+		MinQueue forwardQueue;
+		MinQueue backwardQueue;
+
+		m_forwardData[beginNode] = NodeData{ 0., ContractionHierarchy::InvalidNode, m_searchId };
+		m_backwardData[endNode] = NodeData{ 0., ContractionHierarchy::InvalidNode, m_searchId };
+		forwardQueue.emplace(0., beginNode);
+		backwardQueue.emplace(0., endNode);
+
+		double bestWeight = std::numeric_limits<double>::infinity();
+		uint32_t meetingNode = ContractionHierarchy::InvalidNode;
+
+		bool forward = true, backward = true;
+		while (forward || backward)
+		{
+			if (forward)
+				forward = Step(forwardQueue, m_forwardData, m_backwardData, bestWeight, meetingNode);
+			if (backward)
+				backward = Step(backwardQueue, m_backwardData, m_forwardData, bestWeight, meetingNode);
+		}
+
+		if (meetingNode == ContractionHierarchy::InvalidNode)
+			return m_result;
+
+		if (!FillPath(beginNode, endNode, meetingNode))
+			return m_result;
+		m_pathWeight = bestWeight;
+
+		m_result = IPathFinderResult::Found;
+		return m_result;
+	}
+
+	bool ContractionHierarchyPathFinder::Step(MinQueue& queue, std::vector<NodeData>& data, const std::vector<NodeData>& otherData,
+		double& bestWeight, uint32_t& meetingNode)
+	{
+		while (!queue.empty())
+		{
+			const auto item = queue.top();
+			queue.pop();
+
+			//every path through remaining nodes is longer than the best one
+			if (item.first >= bestWeight)
+				return false;
+			if (item.first > data[item.second].Weight)
+				continue;
+
+			const auto& other = otherData[item.second];
+			if (other.SearchId == m_searchId && item.first + other.Weight < bestWeight)
+			{
+				bestWeight = item.first + other.Weight;
+				meetingNode = item.second;
+			}
+
+			const auto edgesBegin = m_hierarchy.EdgesBegin(item.second);
+			const auto edgesEnd = m_hierarchy.EdgesEnd(item.second);
+
+			//stall-on-demand: the graph is undirected, so a higher ranked neighbour may prove the node is reached suboptimally
+			const bool stalled = std::any_of(edgesBegin, edgesEnd, [&](const ContractionHierarchy::Edge& edge)
+				{
+					const auto& target = data[edge.Target];
+					return target.SearchId == m_searchId && target.Weight + edge.Weight < item.first;
+				});
+			if (stalled)
+				return true;
+
+			for (auto edge = edgesBegin; edge != edgesEnd; ++edge)
+			{
+				const double weight = item.first + edge->Weight;
+				auto& target = data[edge->Target];
+
+				if (target.SearchId == m_searchId && target.Weight <= weight)
+					continue;
+
+				target = NodeData{ weight, item.second, m_searchId };
+				queue.emplace(weight, edge->Target);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool ContractionHierarchyPathFinder::FillPath(uint32_t begin, uint32_t end, uint32_t meetingNode)
+	{
+		std::vector<uint32_t> nodes;
+
+		for (uint32_t node = meetingNode; node != begin; node = m_forwardData[node].Parent)
+		{
+			nodes.emplace_back(node);
+		}
+		nodes.emplace_back(begin);
+		std::reverse(std::begin(nodes), std::end(nodes));
+
+		for (uint32_t node = meetingNode; node != end;)
+		{
+			node = m_backwardData[node].Parent;
+			nodes.emplace_back(node);
+		}
+
+		std::vector<Math::Vector2d> path;
+		for (size_t i = 1; i < nodes.size(); ++i)
+		{
+			if (!UnpackEdge(nodes[i - 1], nodes[i], path))
+				return false;
+		}
+
+		//Path2d keeps the path from the end, without the begin position
+		std::reverse(std::begin(path), std::end(path));
+		m_path = Path2d(std::move(path));
+		return true;
+	}
+
+	bool ContractionHierarchyPathFinder::UnpackEdge(uint32_t from, uint32_t to, std::vector<Math::Vector2d>& path) const
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> stack{ { from, to } };
+
+		while (!stack.empty())
+		{
+			//every stacked edge adds at least one cell and a shortest path visits a cell once,
+			//so a longer unpacking is a cycle of shortcuts in a corrupt index
+			if (path.size() + stack.size() > m_hierarchy.GetNodeCount())
+				return false;
+
+			const auto edge = stack.back();
+			stack.pop_back();
+
+			const auto* hierarchyEdge = m_hierarchy.FindEdge(edge.first, edge.second);
+			if (hierarchyEdge == nullptr)
+				return false;
+
+			if (hierarchyEdge->Middle == ContractionHierarchy::InvalidNode)
+			{
+				path.emplace_back(m_hierarchy.GetPosition(edge.second));
+				continue;
+			}
+
+			stack.emplace_back(hierarchyEdge->Middle, edge.second);
+			stack.emplace_back(edge.first, hierarchyEdge->Middle);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cstdint>
+
+#include "IPathFinder.h"
+#include "Path2d.h"
+#include "ContractionHierarchy.h"
+
+#include "../Math/Vector2d.h"
+
+namespace PathFinder
+{
+	//Двунаправленный поиск пути по иерархии сжатий
+	class ContractionHierarchyPathFinder final : public IPathFinder<Math::Vector2d>
+	{
+	public:
+		ContractionHierarchyPathFinder() = delete;
+		ContractionHierarchyPathFinder(const ContractionHierarchy& hierarchy);
+		~ContractionHierarchyPathFinder() override = default;
+
+		IPathFinderResult FindPath(const Math::Vector2d& begin, const Math::Vector2d& end) override;
+		IPathFinderResult GetResult() const noexcept override { return m_result; }
+		const IPath<Math::Vector2d>& GetPath() const noexcept override { return m_path; }
+
+		double GetPathWeight() const noexcept { return m_pathWeight; }
+
+	private:
+		const ContractionHierarchy& m_hierarchy;
+
+		struct NodeData final
+		{
+			double Weight = 0.;
+			uint32_t Parent = ContractionHierarchy::InvalidNode;
+			//search which has written this entry, avoids clearing between queries
+			uint32_t SearchId = 0u;
+		};
+
+		using QueueItem = std::pair<double, uint32_t>;
+		using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+		std::vector<NodeData> m_forwardData;
+		std::vector<NodeData> m_backwardData;
+		uint32_t m_searchId = 0u;
+
+		Path2d m_path;
+		double m_pathWeight = 0.;
+
+		IPathFinderResult m_result = IPathFinderResult::NotFound;
+
+		bool Step(MinQueue& queue, std::vector<NodeData>& data, const std::vector<NodeData>& otherData,
+			double& bestWeight, uint32_t& meetingNode);
+		bool FillPath(uint32_t begin, uint32_t end, uint32_t meetingNode);
+		//false if the edge does not unpack into a path of at most node count cells
+		bool UnpackEdge(uint32_t from, uint32_t to, std::vector<Math::Vector2d>& path) const;
+	};
+}
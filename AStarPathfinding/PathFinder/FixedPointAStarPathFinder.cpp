@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+
+#include "FixedPointAStarPathFinder.h"
+
+namespace PathFinder
+{
+	constexpr uint32_t FixedPointAStarPathFinder::DefaultStraightCost;
+	constexpr uint32_t FixedPointAStarPathFinder::DefaultDiagonalCost;
+
+	namespace
+	{
+		constexpr uint8_t ClosedFlag = 0x80u;
+		constexpr uint8_t NoParentMove = 0x7Fu;
+
+		struct Move final
+		{
+			ptrdiff_t dX;
+			ptrdiff_t dY;
+			bool IsDiagonal;
+		};
+
+		//straight moves first, 4 way search uses only them
+		constexpr Move Moves[] =
+		{
+			{ -1, 0, false }, { 1, 0, false }, { 0, -1, false }, { 0, 1, false },
+			{ -1, -1, true }, { -1, 1, true }, { 1, -1, true }, { 1, 1, true },
+		};
+		constexpr size_t StraightMoveCount = 4u;
+		constexpr size_t AllMoveCount = sizeof(Moves) / sizeof(Moves[0]);
+	}
+
+	FixedPointAStarPathFinder::FixedPointAStarPathFinder(const World::Map2d& map) :
+		m_map(map),
+		m_width(map.GetWidth()),
+		m_height(map.GetHeight()),
+		m_searchIds(map.GetWidth() * map.GetHeight(), 0u),
+		m_gCosts(map.GetWidth() * map.GetHeight(), 0u),
+		m_parentMoves(map.GetWidth() * map.GetHeight(), 0u)
+	{
+		SetMoveCosts(DefaultStraightCost, DefaultDiagonalCost);
+	}
+
+	bool FixedPointAStarPathFinder::SetMoveCosts(uint32_t straightCost, uint32_t diagonalCost)
+	{
+		//octile distance is consistent only if a diagonal move is not longer than two straight ones
+		if (straightCost == 0u || diagonalCost < straightCost || uint64_t(diagonalCost) > 2u * uint64_t(straightCost))
+			return false;
+
+		const uint64_t maxValue = std::numeric_limits<uint32_t>::max();
+		const uint64_t cellCount = uint64_t(m_width) * uint64_t(m_height);
+		if (cellCount > maxValue)
+			return false;
+
+		//manhattan distance between the corners, not less than any heuristic in both move modes
+		const uint64_t maxHeuristic = cellCount == 0u ? 0u : uint64_t(straightCost) * (uint64_t(m_width) + uint64_t(m_height) - 2u);
+		if (maxHeuristic + diagonalCost > maxValue)
+			return false;
+
+		m_straightCost = straightCost;
+		m_diagonalCost = diagonalCost;
+		m_gCostLimit = uint32_t(maxValue - maxHeuristic - diagonalCost);
+		m_hasCostRange = true;
+
+		ResizeBuckets();
+		return true;
+	}
+
+	void FixedPointAStarPathFinder::ResizeBuckets()
+	{
+		//f of a child is at most f of its parent + 2 * move cost, so open cells never share a bucket with another f
+		size_t bucketCount = 1u;
+		while (bucketCount <= 2u * size_t(std::max(m_straightCost, m_diagonalCost)))
+			bucketCount <<= 1u;
+
+		m_buckets.resize(bucketCount);
+		m_bucketMask = bucketCount - 1u;
+	}
+
+	IPathFinderResult FixedPointAStarPathFinder::FindPath(const Math::Vector2d& begin, const Math::Vector2d& end)
+	{
+		m_result = IPathFinderResult::NotFound;
+		m_begin = begin;
+		m_end = end;
+		m_path = Path2d();
+		m_pathCost = 0u;
+
+		if (!m_hasCostRange || !m_map.IsInside(begin) || !m_map.IsInside(end) ||
+			m_map.GetField(begin) == World::FieldType::Obstacle || m_map.GetField(end) == World::FieldType::Obstacle)
+			return m_result;
+
+		if (++m_searchId == 0u)
+		{
+			std::fill(std::begin(m_searchIds), std::end(m_searchIds), 0u);
+			m_searchId = 1u;
+		}
+		//a search stopped at the end leaves open cells behind
+		for (auto&& bucket : m_buckets)
+		{
+			bucket.clear();
+		}
+
+		const World::FieldType* fields = m_map.GetFields().GetData();
+		const size_t moveCount = m_hasDiagonalMove ? AllMoveCount : StraightMoveCount;
+
+		const uint32_t beginCell = uint32_t(begin.X * m_width + begin.Y);
+		const uint32_t endCell = uint32_t(end.X * m_width + end.Y);
+
+		m_searchIds[beginCell] = m_searchId;
+		m_gCosts[beginCell] = 0u;
+		m_parentMoves[beginCell] = NoParentMove;
+
+		uint32_t fCost = GetHeuristic(begin);
+		m_buckets[fCost & m_bucketMask].emplace_back(beginCell);
+		size_t openCount = 1u;
+
+		while (openCount > 0u)
+		{
+			auto& bucket = m_buckets[fCost & m_bucketMask];
+			if (bucket.empty())
+			{
+				++fCost;
+				continue;
+			}
+
+			const uint32_t cell = bucket.back();
+			bucket.pop_back();
+			--openCount;
+
+			//a cell reopened with a smaller g is popped from a lower bucket first
+			if (m_parentMoves[cell] & ClosedFlag)
+				continue;
+			m_parentMoves[cell] |= ClosedFlag;
+
+			if (cell == endCell)
+			{
+				m_pathCost = m_gCosts[cell];
+				FillPath(endCell);
+
+				m_result = IPathFinderResult::Found;
+				return m_result;
+			}
+
+			const uint32_t gCost = m_gCosts[cell];
+			//f of the children would overflow, no path fits 32 bit costs
+			if (gCost > m_gCostLimit)
+				break;
+
+			const size_t x = cell / m_width;
+			const size_t y = cell % m_width;
+
+			for (size_t move = 0; move < moveCount; ++move)
+			{
+				//negative moves wrap around and fail the bounds check
+				const size_t childX = x + size_t(Moves[move].dX);
+				const size_t childY = y + size_t(Moves[move].dY);
+				if (childX >= m_height || childY >= m_width)
+					continue;
+
+				const uint32_t child = uint32_t(childX * m_width + childY);
+				if (fields[child] == World::FieldType::Obstacle)
+					continue;
+
+				const uint32_t childCost = gCost + (Moves[move].IsDiagonal ? m_diagonalCost : m_straightCost);
+				if (m_searchIds[child] == m_searchId)
+				{
+					//closed cells already have the smallest g
+					if (childCost >= m_gCosts[child])
+						continue;
+				}
+				else
+				{
+					m_searchIds[child] = m_searchId;
+				}
+
+				m_gCosts[child] = childCost;
+				m_parentMoves[child] = uint8_t(move);
+
+				const uint32_t childF = childCost + GetHeuristic(Math::Vector2d{ childX, childY });
+				m_buckets[childF & m_bucketMask].emplace_back(child);
+				++openCount;
+			}
+		}
+
+		return m_result;
+	}
+
+	uint32_t FixedPointAStarPathFinder::GetHeuristic(const Math::Vector2d& position) const noexcept
+	{
+		return m_hasDiagonalMove ?
+			Math::OctileDistance(position, m_end, m_straightCost, m_diagonalCost) :
+			uint32_t(Math::ManhattanDistance(position, m_end)) * m_straightCost;
+	}
+
+	void FixedPointAStarPathFinder::FillPath(uint32_t endCell)
+	{
+		const uint32_t beginCell = uint32_t(m_begin.X * m_width + m_begin.Y);
+		std::vector<Math::Vector2d> path;
+
+		for (uint32_t cell = endCell; cell != beginCell;)
+		{
+			const Math::Vector2d position{ cell / m_width, cell % m_width };
+			path.emplace_back(position);
+
+			const auto& move = Moves[m_parentMoves[cell] & ~ClosedFlag];
+			cell = uint32_t((position.X - size_t(move.dX)) * m_width + (position.Y - size_t(move.dY)));
+		}
+
+		m_path = Path2d(std::move(path));
+	}
+}
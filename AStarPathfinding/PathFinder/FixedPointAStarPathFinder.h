@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "IPathFinder.h"
+#include "Path2d.h"
+
+#include "../World/Map2d.h"
+#include "../Math/Vector2d.h"
+
+namespace PathFinder
+{
+	/// <summary>
+	/// Поиск пути алгоритмом А* с целочисленными весами (fixed point).
+	///
+	/// Ходы стоят straightCost и diagonalCost, эвристика - octile distance в тех же единицах:
+	/// она согласованная, поэтому f вершин не убывает и открытый список - кольцо корзин по f
+	/// (Dial) без сравнений. На клетку хранится 32-битный g, номер поиска и направление на родителя.
+	/// Поиск, у которого g дошёл до предела 32 бит, прерывается с NotFound.
+	/// </summary>
+	class FixedPointAStarPathFinder final : public IPathFinder<Math::Vector2d>
+	{
+	public:
+		//2^8 and round(2^8 * sqrt(2)): 0.01% error of the diagonal, paths up to 11M diagonal moves fit 32 bits
+		static constexpr uint32_t DefaultStraightCost = 256u;
+		static constexpr uint32_t DefaultDiagonalCost = 362u;
+
+		FixedPointAStarPathFinder() = delete;
+		FixedPointAStarPathFinder(const World::Map2d& map);
+		~FixedPointAStarPathFinder() override = default;
+
+		IPathFinderResult FindPath(const Math::Vector2d& begin, const Math::Vector2d& end) override;
+		IPathFinderResult GetResult() const noexcept override { return m_result; }
+		const IPath<Math::Vector2d>& GetPath() const noexcept override { return m_path; }
+
+		//in move cost units
+		uint32_t GetPathCost() const noexcept { return m_pathCost; }
+		//in cells, comparable with the weights of the other finders
+		double GetPathWeight() const noexcept { return double(m_pathCost) / double(m_straightCost); }
+
+		//diagonalCost is ignored without diagonal moves; false if the costs are invalid or the heuristic
+		//across the map does not fit 32 bits, the previous costs are kept then
+		bool SetMoveCosts(uint32_t straightCost, uint32_t diagonalCost);
+		uint32_t GetStraightCost() const noexcept { return m_straightCost; }
+		uint32_t GetDiagonalCost() const noexcept { return m_diagonalCost; }
+
+		void SetHasDiagonalMove(bool has) noexcept { m_hasDiagonalMove = has; }
+
+	private:
+		const World::Map2d& m_map;
+		const size_t m_width;
+		const size_t m_height;
+
+		uint32_t m_straightCost = DefaultStraightCost;
+		uint32_t m_diagonalCost = DefaultDiagonalCost;
+		bool m_hasDiagonalMove = true;
+		//cells with a larger g are not expanded, so f of their children can not overflow
+		uint32_t m_gCostLimit = 0u;
+		//false if the map is too large for 32 bit cells and costs
+		bool m_hasCostRange = false;
+
+		//cell data is valid only if its search id is the current one, so nothing is cleared between searches
+		std::vector<uint32_t> m_searchIds;
+		std::vector<uint32_t> m_gCosts;
+		//index of the move from the parent, ClosedFlag is set after the expansion
+		std::vector<uint8_t> m_parentMoves;
+		uint32_t m_searchId = 0u;
+
+		//bucket f & m_bucketMask holds cells with this f; stale entries are skipped on pop
+		std::vector<std::vector<uint32_t>> m_buckets;
+		size_t m_bucketMask = 0u;
+
+		Math::Vector2d m_begin;
+		Math::Vector2d m_end;
+
+		Path2d m_path;
+		uint32_t m_pathCost = 0u;
+		IPathFinderResult m_result = IPathFinderResult::NotFound;
+
+		void ResizeBuckets();
+		uint32_t GetHeuristic(const Math::Vector2d& position) const noexcept;
+		void FillPath(uint32_t endCell);
+	};
+}
@@ -0,0 +1,344 @@
+#include <cassert>
+#include <queue>
+#include <algorithm>
+#include <thread>
+#include <limits>
+#include <functional>
+#include <chrono>
+
+#include "ParallelAStarPathFinder.h"
+
+namespace PathFinder
+{
+	namespace
+	{
+		//cells of one block belong to one thread, so most successors stay local
+		constexpr size_t OwnerBlockShift = 3u;
+		constexpr size_t MessageBatchSize = 64u;
+		//expansions between outbox flushes, keeps other threads fed
+		constexpr size_t FlushInterval = 32u;
+		//idle polls before an idle thread starts to sleep instead of spinning
+		constexpr size_t IdleSpinCount = 64u;
+		constexpr auto IdleSleepTime = std::chrono::microseconds(20);
+
+		constexpr double Infinity = std::numeric_limits<double>::infinity();
+
+		struct OpenNode final
+		{
+			double fWeight = 0.;
+			double gWeight = 0.;
+			uint32_t Cell = 0u;
+
+			bool operator > (const OpenNode& rhs) const noexcept { return fWeight > rhs.fWeight; }
+		};
+	}
+
+	class ParallelAStarPathFinder::SearchThread final
+	{
+	public:
+		SearchThread(ParallelAStarPathFinder& finder, size_t index) :
+			m_finder(finder), m_index(index), m_outboxes(finder.m_threadCount),
+			m_endCell(finder.GetCell(finder.m_end))
+		{
+		}
+
+		void Run(const Message* beginMessage)
+		{
+			if (beginMessage != nullptr)
+				Receive(*beginMessage);
+
+			auto& inbox = *m_finder.m_inboxes[m_index];
+			auto& pending = m_finder.m_pending;
+
+			bool busy = true;
+			size_t expanded = 0u;
+			size_t idlePolls = 0u;
+
+			while (true)
+			{
+				size_t batches = inbox.ConsumeAll([this](std::vector<Message>& batch)
+					{
+						for (auto&& message : batch)
+							Receive(message);
+					});
+
+				if (batches > 0u)
+				{
+					idlePolls = 0u;
+
+					//the first batch carries the "busy" count of an idle thread
+					if (!busy)
+					{
+						busy = true;
+						--batches;
+					}
+					if (batches > 0u)
+						pending.fetch_sub(batches);
+				}
+
+				if (busy)
+				{
+					if (ExpandNext())
+					{
+						if (++expanded % FlushInterval == 0u)
+							FlushAll();
+						continue;
+					}
+
+					FlushAll();
+					if (!inbox.IsEmpty())
+						continue;
+
+					busy = false;
+					pending.fetch_sub(1u);
+				}
+
+				if (pending.load() == 0u)
+					break;
+
+				if (++idlePolls < IdleSpinCount)
+					std::this_thread::yield();
+				else
+					std::this_thread::sleep_for(IdleSleepTime);
+			}
+
+			//nobody reads g after the termination, leave the array clean for the next search
+			for (auto cell : m_touched)
+			{
+				m_finder.m_gWeights[cell].store(Infinity, std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		ParallelAStarPathFinder& m_finder;
+		const size_t m_index;
+
+		std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> m_openList;
+		std::vector<std::vector<Message>> m_outboxes;
+		std::vector<uint32_t> m_touched;
+		const uint32_t m_endCell;
+
+		void Receive(const Message& message)
+		{
+			auto& gWeight = m_finder.m_gWeights[message.Cell];
+			const double oldWeight = gWeight.load(std::memory_order_relaxed);
+			if (message.gWeight >= oldWeight)
+				return;
+
+			if (oldWeight == Infinity)
+				m_touched.emplace_back(message.Cell);
+
+			gWeight.store(message.gWeight, std::memory_order_relaxed);
+			m_finder.m_parents[message.Cell] = message.ParentCell;
+
+			const double hWeight = m_finder.GetDistance(m_finder.GetPosition(message.Cell), m_finder.m_end);
+			m_openList.push(OpenNode{ message.gWeight + hWeight, message.gWeight, message.Cell });
+		}
+
+		bool ExpandNext()
+		{
+			while (!m_openList.empty())
+			{
+				const auto node = m_openList.top();
+				m_openList.pop();
+
+				const double bestWeight = m_finder.m_bestWeight.load(std::memory_order_relaxed);
+				if (node.fWeight >= bestWeight)
+				{
+					//every local node is worse than the known path
+					m_openList = decltype(m_openList)();
+					return false;
+				}
+				if (node.gWeight > m_finder.m_gWeights[node.Cell].load(std::memory_order_relaxed))
+					continue;
+
+				if (node.Cell == m_endCell)
+				{
+					double current = bestWeight;
+					while (node.gWeight < current && !m_finder.m_bestWeight.compare_exchange_weak(current, node.gWeight))
+					{
+					}
+					continue;
+				}
+
+				Expand(node, bestWeight);
+				return true;
+			}
+			return false;
+		}
+
+		void Expand(const OpenNode& node, double bestWeight)
+		{
+			const auto position = m_finder.GetPosition(node.Cell);
+
+			auto expand = [&](const Math::Vector2d& childPosition)
+			{
+				if (!m_finder.m_map.IsInside(childPosition) || m_finder.m_map.GetField(childPosition) == World::FieldType::Obstacle)
+					return;
+
+				const uint32_t cell = m_finder.GetCell(childPosition);
+				const double gWeight = node.gWeight + m_finder.GetDistance(position, childPosition);
+				if (gWeight + m_finder.GetDistance(childPosition, m_finder.m_end) >= bestWeight)
+					return;
+				//may be stale for other owners, the owner checks again on receive
+				if (gWeight >= m_finder.m_gWeights[cell].load(std::memory_order_relaxed))
+					return;
+
+				const size_t owner = m_finder.GetOwner(cell);
+				if (owner == m_index)
+				{
+					Receive(Message{ cell, node.Cell, gWeight });
+					return;
+				}
+
+				m_outboxes[owner].emplace_back(Message{ cell, node.Cell, gWeight });
+				if (m_outboxes[owner].size() >= MessageBatchSize)
+					Flush(owner);
+			};
+
+			if (m_finder.m_hasDiagonalMove)
+			{
+				for (auto&& childPosition : Math::GetNeighours8way(position))
+					expand(childPosition);
+			}
+			else
+			{
+				for (auto&& childPosition : Math::GetNeighours4way(position))
+					expand(childPosition);
+			}
+		}
+
+		void Flush(size_t owner)
+		{
+			auto& outbox = m_outboxes[owner];
+			if (outbox.empty())
+				return;
+
+			//counted before the push, so the batch is never invisible to the termination check
+			m_finder.m_pending.fetch_add(1u);
+			m_finder.m_inboxes[owner]->Push(std::move(outbox));
+
+			outbox = std::vector<Message>();
+			outbox.reserve(MessageBatchSize);
+		}
+
+		void FlushAll()
+		{
+			for (size_t owner = 0; owner < m_outboxes.size(); ++owner)
+			{
+				Flush(owner);
+			}
+		}
+	};
+
+	ParallelAStarPathFinder::ParallelAStarPathFinder(const World::Map2d& map, size_t threadCount) :
+		m_map(map),
+		m_width(map.GetWidth()),
+		m_height(map.GetHeight()),
+		m_gWeights(new std::atomic<double>[map.GetWidth() * map.GetHeight()]),
+		m_parents(map.GetWidth() * map.GetHeight())
+	{
+		assert(m_width * m_height <= std::numeric_limits<uint32_t>::max());
+
+		for (size_t cell = 0; cell < m_width * m_height; ++cell)
+		{
+			m_gWeights[cell].store(Infinity, std::memory_order_relaxed);
+		}
+
+		SetThreadCount(threadCount);
+	}
+
+	void ParallelAStarPathFinder::SetThreadCount(size_t threadCount)
+	{
+		if (threadCount == 0u)
+			threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1u);
+
+		m_threadCount = threadCount;
+
+		m_inboxes.clear();
+		for (size_t i = 0; i < m_threadCount; ++i)
+		{
+			m_inboxes.emplace_back(std::make_unique<Threading::MpscStack<std::vector<Message>>>());
+		}
+	}
+
+	IPathFinderResult ParallelAStarPathFinder::FindPath(const Math::Vector2d& begin, const Math::Vector2d& end)
+	{
+		m_result = IPathFinderResult::NotFound;
+		m_begin = begin;
+		m_end = end;
+		m_path = Path2d();
+		m_pathWeight = 0.;
+
+		if (!m_map.IsInside(begin) || !m_map.IsInside(end) ||
+			m_map.GetField(begin) == World::FieldType::Obstacle || m_map.GetField(end) == World::FieldType::Obstacle)
+			return m_result;
+
+		m_pending.store(m_threadCount);
+		m_bestWeight.store(Infinity);
+
+		const uint32_t beginCell = GetCell(begin);
+		const Message beginMessage{ beginCell, beginCell, 0. };
+		const size_t beginOwner = GetOwner(beginCell);
+
+		std::vector<std::unique_ptr<SearchThread>> searchThreads;
+		for (size_t i = 0; i < m_threadCount; ++i)
+		{
+			searchThreads.emplace_back(std::make_unique<SearchThread>(*this, i));
+		}
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < m_threadCount; ++i)
+		{
+			SearchThread& searchThread = *searchThreads[i];
+			threads.emplace_back([&searchThread, &beginMessage, i, beginOwner]()
+				{
+					searchThread.Run(i == beginOwner ? &beginMessage : nullptr);
+				});
+		}
+		searchThreads[0]->Run(beginOwner == 0u ? &beginMessage : nullptr);
+
+		for (auto&& thread : threads)
+		{
+			thread.join();
+		}
+
+		if (m_bestWeight.load() == Infinity)
+			return m_result;
+
+		m_pathWeight = m_bestWeight.load();
+		FillPath();
+
+		m_result = IPathFinderResult::Found;
+		return m_result;
+	}
+
+	size_t ParallelAStarPathFinder::GetOwner(uint32_t cell) const noexcept
+	{
+		const size_t x = (cell / m_width) >> OwnerBlockShift;
+		const size_t y = (cell % m_width) >> OwnerBlockShift;
+
+		size_t hash = x * 0x9E3779B1u ^ y * 0x85EBCA77u;
+		hash ^= hash >> 15;
+		return hash % m_threadCount;
+	}
+
+	double ParallelAStarPathFinder::GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept
+	{
+		return m_hasDiagonalMove ? Math::EuclideanDistance(lhs, rhs) : double(Math::ManhattanDistance(lhs, rhs));
+	}
+
+	void ParallelAStarPathFinder::FillPath()
+	{
+		const uint32_t beginCell = GetCell(m_begin);
+		std::vector<Math::Vector2d> path;
+
+		//parents have strictly smaller g, so the chain always reaches the begin
+		for (uint32_t cell = GetCell(m_end); cell != beginCell; cell = m_parents[cell])
+		{
+			path.emplace_back(GetPosition(cell));
+		}
+
+		m_path = Path2d(std::move(path));
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "IPathFinder.h"
+#include "Path2d.h"
+
+#include "../World/Map2d.h"
+#include "../Math/Vector2d.h"
+#include "../Threading/MpscStack.h"
+
+namespace PathFinder
+{
+	namespace details
+	{
+		struct ParallelAStarMessage final
+		{
+			uint32_t Cell = 0u;
+			uint32_t ParentCell = 0u;
+			double gWeight = 0.;
+		};
+	}
+
+	/// <summary>
+	/// Поиск пути алгоритмом A* в несколько потоков (Hash Distributed A*).
+	///
+	/// Каждая клетка принадлежит одному потоку (по хешу блока клеток), только он
+	/// раскрывает её и пишет её g. Новые вершины отправляются владельцу пачками через
+	/// lock-free очередь. Поиск заканчивается, когда все потоки простаивают и нет
+	/// сообщений в пути, поэтому найденный путь оптимален.
+	/// </summary>
+	class ParallelAStarPathFinder final : public IPathFinder<Math::Vector2d>
+	{
+		using Message = details::ParallelAStarMessage;
+
+	public:
+		ParallelAStarPathFinder() = delete;
+		ParallelAStarPathFinder(const World::Map2d& map, size_t threadCount = 0u);
+		~ParallelAStarPathFinder() override = default;
+
+		IPathFinderResult FindPath(const Math::Vector2d& begin, const Math::Vector2d& end) override;
+		IPathFinderResult GetResult() const noexcept override { return m_result; }
+		const IPath<Math::Vector2d>& GetPath() const noexcept override { return m_path; }
+
+		double GetPathWeight() const noexcept { return m_pathWeight; }
+
+		//0 - hardware concurrency
+		void SetThreadCount(size_t threadCount);
+		size_t GetThreadCount() const noexcept { return m_threadCount; }
+
+		void SetHasDiagonalMove(bool has) noexcept { m_hasDiagonalMove = has; }
+
+	private:
+		class SearchThread;
+
+		const World::Map2d& m_map;
+		const size_t m_width;
+		const size_t m_height;
+
+		//best known g of every cell, written only by the owner thread
+		std::unique_ptr<std::atomic<double>[]> m_gWeights;
+		std::vector<uint32_t> m_parents;
+
+		std::vector<std::unique_ptr<Threading::MpscStack<std::vector<Message>>>> m_inboxes;
+		//in-flight message batches + busy threads, the search is over at 0
+		std::atomic<size_t> m_pending{ 0u };
+		std::atomic<double> m_bestWeight{ 0. };
+
+		size_t m_threadCount = 1u;
+		bool m_hasDiagonalMove = true;
+
+		Math::Vector2d m_begin;
+		Math::Vector2d m_end;
+
+		Path2d m_path;
+		double m_pathWeight = 0.;
+		IPathFinderResult m_result = IPathFinderResult::NotFound;
+
+		size_t GetOwner(uint32_t cell) const noexcept;
+		double GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept;
+		Math::Vector2d GetPosition(uint32_t cell) const noexcept { return Math::Vector2d{ cell / m_width, cell % m_width }; }
+		uint32_t GetCell(const Math::Vector2d& position) const noexcept { return uint32_t(position.X * m_width + position.Y); }
+
+		void FillPath();
+	};
+}
@@ -1,6 +1,10 @@
 #pragma once
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
 #include "IPath.h"
-#include "..\Math\Vector2d.h"
+#include "../Math/Vector2d.h"
 
 namespace PathFinder
 {
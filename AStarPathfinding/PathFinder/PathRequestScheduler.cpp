@@ -0,0 +1,385 @@
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <limits>
+
+#include "PathRequestScheduler.h"
+#include "AStarPathFinder.h"
+
+#include "../Math/Matrix2d.h"
+
+namespace PathFinder
+{
+	namespace
+	{
+		double ToMilliseconds(PathRequestScheduler::Clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		bool IsLess(const Math::Vector2d& lhs, const Math::Vector2d& rhs) noexcept
+		{
+			return lhs.X < rhs.X || (lhs.X == rhs.X && lhs.Y < rhs.Y);
+		}
+	}
+
+	/// <summary>
+	/// Поток пула со своими данными поиска.
+	///
+	/// Обратный поиск - A* от цели сразу ко всем началам группы, эвристика -
+	/// минимум расстояний до начал, поэтому остаётся монотонной.
+	/// </summary>
+	class PathRequestScheduler::Worker final
+	{
+	public:
+		Worker(const World::Map2d& map, bool hasDiagonalMove) :
+			m_map(map), m_finder(map), m_searchData(map.GetWidth(), map.GetHeight()), m_hasDiagonalMove(hasDiagonalMove)
+		{
+			m_finder.SetHasDiagonalMove(hasDiagonalMove);
+		}
+
+		std::thread Thread;
+
+		PathRequestResult FindPath(const Math::Vector2d& begin, const Math::Vector2d& end)
+		{
+			PathRequestResult result;
+			//AStarPathFinder expects both positions inside the map and free
+			if (!IsFree(begin) || !IsFree(end))
+				return result;
+
+			result.Result = m_finder.FindPath(begin, end);
+			if (result.Result == IPathFinderResult::Found)
+				result.Path = static_cast<const Path2d&>(m_finder.GetPath());
+			return result;
+		}
+
+		void FindPaths(const std::vector<Math::Vector2d>& begins, const Math::Vector2d& end, std::vector<PathRequestResult>& results)
+		{
+			results.assign(begins.size(), PathRequestResult());
+			if (!IsFree(end))
+				return;
+
+			++m_searchId;
+			std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> openList;
+
+			m_searchData.SetField(end, NodeData{ end, 0., m_searchId, false });
+			openList.push(OpenNode{ GetHeuristic(end, begins), 0., end });
+
+			size_t remaining = begins.size();
+			while (!openList.empty() && remaining > 0u)
+			{
+				const auto node = openList.top();
+				openList.pop();
+
+				auto nodeData = m_searchData.GetField(node.Position);
+				if (nodeData.Closed || node.gWeight > nodeData.GWeight)
+					continue;
+				nodeData.Closed = true;
+				m_searchData.SetField(node.Position, nodeData);
+
+				for (size_t i = 0; i < begins.size(); ++i)
+				{
+					if (begins[i] == node.Position)
+					{
+						results[i].Result = IPathFinderResult::Found;
+						results[i].Path = GetPath(begins[i], end);
+						--remaining;
+					}
+				}
+
+				auto expand = [&](const Math::Vector2d& position)
+				{
+					if (!IsFree(position))
+						return;
+
+					const double gWeight = node.gWeight + GetDistance(node.Position, position);
+					auto childData = m_searchData.GetField(position);
+					//the heuristic is consistent, closed nodes are never improved (except by rounding)
+					if (childData.SearchId == m_searchId && (childData.Closed || childData.GWeight <= gWeight))
+						return;
+
+					m_searchData.SetField(position, NodeData{ node.Position, gWeight, m_searchId, false });
+					openList.push(OpenNode{ gWeight + GetHeuristic(position, begins), gWeight, position });
+				};
+
+				if (m_hasDiagonalMove)
+				{
+					for (auto&& position : Math::GetNeighours8way(node.Position))
+						expand(position);
+				}
+				else
+				{
+					for (auto&& position : Math::GetNeighours4way(node.Position))
+						expand(position);
+				}
+			}
+		}
+
+	private:
+		struct NodeData final
+		{
+			Math::Vector2d ParentPosition;
+			double GWeight = 0.;
+			//search which has written this entry, avoids clearing between searches
+			size_t SearchId = 0u;
+			bool Closed = false;
+		};
+
+		struct OpenNode final
+		{
+			double fWeight = 0.;
+			double gWeight = 0.;
+			Math::Vector2d Position;
+
+			bool operator > (const OpenNode& rhs) const noexcept { return fWeight > rhs.fWeight; }
+		};
+
+		const World::Map2d& m_map;
+		AStarPathFinder m_finder;
+		Math::Matrix2d<NodeData> m_searchData;
+		size_t m_searchId = 0u;
+		bool m_hasDiagonalMove = true;
+
+		bool IsFree(const Math::Vector2d& position) const noexcept
+		{
+			return m_map.IsInside(position) && m_map.GetField(position) != World::FieldType::Obstacle;
+		}
+
+		double GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept
+		{
+			return m_hasDiagonalMove ? Math::EuclideanDistance(lhs, rhs) : double(Math::ManhattanDistance(lhs, rhs));
+		}
+
+		double GetHeuristic(const Math::Vector2d& position, const std::vector<Math::Vector2d>& begins) const noexcept
+		{
+			double result = std::numeric_limits<double>::infinity();
+			for (auto&& begin : begins)
+			{
+				result = std::min(result, GetDistance(position, begin));
+			}
+			return result;
+		}
+
+		//the search runs from the end, so parents lead from begin to end
+		Path2d GetPath(const Math::Vector2d& begin, const Math::Vector2d& end) const
+		{
+			std::vector<Math::Vector2d> path;
+
+			auto currentPosition = begin;
+			while (currentPosition != end)
+			{
+				currentPosition = m_searchData.GetField(currentPosition).ParentPosition;
+				path.emplace_back(currentPosition);
+			}
+
+			//Path2d keeps the path from the end, without the begin position
+			std::reverse(std::begin(path), std::end(path));
+			return Path2d(std::move(path));
+		}
+	};
+
+	PathRequestScheduler::PathRequestScheduler(const World::Map2d& map, size_t workerCount, bool hasDiagonalMove) :
+		m_map(map), m_hasDiagonalMove(hasDiagonalMove), m_startTime(Clock::now())
+	{
+		assert(workerCount > 0u);
+
+		for (size_t i = 0; i < workerCount; ++i)
+		{
+			m_workers.emplace_back(std::make_unique<Worker>(m_map, m_hasDiagonalMove));
+		}
+		for (auto&& worker : m_workers)
+		{
+			Worker& current = *worker;
+			worker->Thread = std::thread([this, &current]() { WorkerLoop(current); });
+		}
+	}
+
+	PathRequestScheduler::~PathRequestScheduler()
+	{
+		//requests submitted after the last tick are served too, the workers drain the jobs before they stop
+		Tick();
+
+		{
+			std::lock_guard<std::mutex> lock(m_jobsMutex);
+			m_stopped = true;
+		}
+		m_jobsCondition.notify_all();
+
+		for (auto&& worker : m_workers)
+		{
+			worker->Thread.join();
+		}
+	}
+
+	std::future<PathRequestResult> PathRequestScheduler::Submit(const Math::Vector2d& begin, const Math::Vector2d& end, Clock::time_point deadline)
+	{
+		Request request{ begin, end, deadline, Clock::now(), std::promise<PathRequestResult>() };
+		auto future = request.Promise.get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(m_pendingMutex);
+			m_pending.emplace_back(std::move(request));
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_metricsMutex);
+			++m_metrics.Submitted;
+		}
+
+		return future;
+	}
+
+	void PathRequestScheduler::Tick()
+	{
+		std::vector<Request> requests;
+		{
+			std::lock_guard<std::mutex> lock(m_pendingMutex);
+			requests.swap(m_pending);
+		}
+		if (requests.empty())
+			return;
+
+		//group by goal, identical requests become adjacent
+		std::sort(std::begin(requests), std::end(requests), [](const Request& lhs, const Request& rhs)
+			{
+				if (lhs.End != rhs.End)
+					return IsLess(lhs.End, rhs.End);
+				return IsLess(lhs.Begin, rhs.Begin);
+			});
+
+		std::vector<std::unique_ptr<Job>> jobs;
+		size_t deduplicated = 0u;
+
+		for (auto&& request : requests)
+		{
+			if (jobs.empty() || jobs.back()->End != request.End)
+			{
+				jobs.emplace_back(std::make_unique<Job>());
+				jobs.back()->End = request.End;
+				jobs.back()->Deadline = request.Deadline;
+			}
+
+			auto& job = *jobs.back();
+			if (!job.Requests.empty() && job.Requests.back().Begin == request.Begin)
+				++deduplicated;
+
+			job.Deadline = std::min(job.Deadline, request.Deadline);
+			job.Requests.emplace_back(std::move(request));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_metricsMutex);
+			m_metrics.Deduplicated += deduplicated;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_jobsMutex);
+			for (auto&& job : jobs)
+			{
+				m_jobs.emplace_back(std::move(job));
+				std::push_heap(std::begin(m_jobs), std::end(m_jobs), JobCompare());
+			}
+		}
+		m_jobsCondition.notify_all();
+	}
+
+	PathRequestSchedulerMetrics PathRequestScheduler::GetMetrics() const
+	{
+		std::lock_guard<std::mutex> lock(m_metricsMutex);
+
+		PathRequestSchedulerMetrics result = m_metrics;
+
+		const double elapsed = std::chrono::duration<double>(Clock::now() - m_startTime).count();
+		result.Throughput = elapsed > 0. ? double(result.Completed) / elapsed : 0.;
+		result.AverageQueueLatency = result.Completed > 0u ? m_totalQueueLatency / double(result.Completed) : 0.;
+
+		return result;
+	}
+
+	void PathRequestScheduler::WorkerLoop(Worker& worker)
+	{
+		while (true)
+		{
+			std::unique_ptr<Job> job;
+			{
+				std::unique_lock<std::mutex> lock(m_jobsMutex);
+				m_jobsCondition.wait(lock, [this]() { return m_stopped || !m_jobs.empty(); });
+
+				if (m_jobs.empty())
+					return;
+
+				std::pop_heap(std::begin(m_jobs), std::end(m_jobs), JobCompare());
+				job = std::move(m_jobs.back());
+				m_jobs.pop_back();
+			}
+
+			RunJob(worker, *job);
+		}
+	}
+
+	void PathRequestScheduler::RunJob(Worker& worker, Job& job)
+	{
+		const auto startTime = Clock::now();
+		{
+			std::lock_guard<std::mutex> lock(m_metricsMutex);
+			for (auto&& request : job.Requests)
+			{
+				const double latency = ToMilliseconds(startTime - request.SubmitTime);
+				m_totalQueueLatency += latency;
+				m_metrics.MaxQueueLatency = std::max(m_metrics.MaxQueueLatency, latency);
+			}
+		}
+
+		std::vector<Math::Vector2d> begins;
+		for (auto&& request : job.Requests)
+		{
+			if (begins.empty() || begins.back() != request.Begin)
+				begins.emplace_back(request.Begin);
+		}
+
+		std::vector<PathRequestResult> results;
+		if (begins.size() == 1u)
+		{
+			results.emplace_back(worker.FindPath(begins.front(), job.End));
+		}
+		else
+		{
+			worker.FindPaths(begins, job.End, results);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_metricsMutex);
+			++m_metrics.Searches;
+			if (begins.size() > 1u)
+				++m_metrics.SharedSearches;
+		}
+
+		const auto now = Clock::now();
+		for (auto&& result : results)
+		{
+			result.CompletionTime = now;
+		}
+
+		size_t index = 0u;
+		for (auto&& request : job.Requests)
+		{
+			if (begins[index] != request.Begin)
+				++index;
+
+			Complete(request, results[index], now);
+		}
+	}
+
+	void PathRequestScheduler::Complete(Request& request, const PathRequestResult& result, Clock::time_point now)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_metricsMutex);
+			++m_metrics.Completed;
+			if (now > request.Deadline)
+				++m_metrics.DeadlineMissed;
+		}
+
+		request.Promise.set_value(result);
+	}
+}
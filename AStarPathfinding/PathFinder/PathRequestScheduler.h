@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "IPathFinder.h"
+#include "Path2d.h"
+
+#include "../World/Map2d.h"
+#include "../Math/Vector2d.h"
+
+namespace PathFinder
+{
+	struct PathRequestResult final
+	{
+		IPathFinderResult Result = IPathFinderResult::NotFound;
+		Path2d Path;
+		//end of the search which answered the request
+		std::chrono::steady_clock::time_point CompletionTime;
+	};
+
+	struct PathRequestSchedulerMetrics final
+	{
+		size_t Submitted = 0u;
+		//requests answered by the search of an identical request in the same tick
+		size_t Deduplicated = 0u;
+		size_t Searches = 0u;
+		//searches from a goal serving several begin positions
+		size_t SharedSearches = 0u;
+		size_t Completed = 0u;
+		size_t DeadlineMissed = 0u;
+
+		//completed requests per second since the scheduler start
+		double Throughput = 0.;
+		//time from Submit to the start of the search, ms
+		double AverageQueueLatency = 0.;
+		double MaxQueueLatency = 0.;
+	};
+
+	/// <summary>
+	/// Очередь запросов поиска пути от многих агентов.
+	///
+	/// Запросы копятся до вызова Tick: одинаковые (begin, end) ищутся один раз,
+	/// запросы с общей целью обслуживаются одним обратным поиском от цели,
+	/// задачи раздаются пулу потоков в порядке дедлайнов.
+	/// </summary>
+	class PathRequestScheduler final
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		PathRequestScheduler() = delete;
+		PathRequestScheduler(const World::Map2d& map, size_t workerCount, bool hasDiagonalMove = true);
+		PathRequestScheduler(const PathRequestScheduler&) = delete;
+		PathRequestScheduler& operator=(const PathRequestScheduler&) = delete;
+		//waits for every submitted request, including those submitted after the last Tick
+		~PathRequestScheduler();
+
+		std::future<PathRequestResult> Submit(const Math::Vector2d& begin, const Math::Vector2d& end, Clock::time_point deadline);
+
+		//dispatch requests submitted since the previous tick
+		void Tick();
+
+		PathRequestSchedulerMetrics GetMetrics() const;
+
+	private:
+		struct Request final
+		{
+			Math::Vector2d Begin;
+			Math::Vector2d End;
+			Clock::time_point Deadline;
+			Clock::time_point SubmitTime;
+			std::promise<PathRequestResult> Promise;
+		};
+
+		//all requests of one goal, requests with the same begin are adjacent
+		struct Job final
+		{
+			Math::Vector2d End;
+			Clock::time_point Deadline;
+			std::vector<Request> Requests;
+		};
+
+		struct JobCompare final
+		{
+			bool operator()(const std::unique_ptr<Job>& lhs, const std::unique_ptr<Job>& rhs) const noexcept
+			{
+				return lhs->Deadline > rhs->Deadline;
+			}
+		};
+
+		class Worker;
+
+		const World::Map2d& m_map;
+		const bool m_hasDiagonalMove;
+		const Clock::time_point m_startTime;
+
+		std::mutex m_pendingMutex;
+		std::vector<Request> m_pending;
+
+		std::mutex m_jobsMutex;
+		std::condition_variable m_jobsCondition;
+		//binary heap by deadline
+		std::vector<std::unique_ptr<Job>> m_jobs;
+		bool m_stopped = false;
+
+		mutable std::mutex m_metricsMutex;
+		PathRequestSchedulerMetrics m_metrics;
+		double m_totalQueueLatency = 0.;
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+
+		void WorkerLoop(Worker& worker);
+		void RunJob(Worker& worker, Job& job);
+		void Complete(Request& request, const PathRequestResult& result, Clock::time_point now);
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "../Math/Vector2d.h"
+#include "../Threading/SpscRingBuffer.h"
+
+namespace PathFinder
+{
+	enum class SearchEventType : unsigned char
+	{
+		//added to the open list or reopened with a better weight
+		Opened,
+		//moved from the open list to the closed list
+		Closed
+	};
+
+	//Изменение списков поиска, для отображения поиска во время работы
+	struct SearchEvent final
+	{
+		Math::Vector2d Position;
+		SearchEventType Type = SearchEventType::Opened;
+	};
+
+	using SearchEventBuffer = Threading::SpscRingBuffer<SearchEvent>;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+namespace Storage
+{
+	/// <summary>
+	/// Непрерывный массив без владения: std::vector или секция snapshot.
+	///
+	/// Хранилище должно жить дольше view.
+	/// </summary>
+	template<typename T>
+	class ArrayView final
+	{
+		const T* m_data = nullptr;
+		size_t m_size = 0u;
+
+	public:
+		ArrayView() = default;
+		ArrayView(const T* data, size_t size) noexcept : m_data(data), m_size(size) {}
+		ArrayView(const std::vector<T>& array) noexcept : m_data(array.data()), m_size(array.size()) {}
+
+		const T* GetData() const noexcept { return m_data; }
+		size_t GetSize() const noexcept { return m_size; }
+		bool IsEmpty() const noexcept { return m_size == 0u; }
+
+		const T& operator[](size_t index) const noexcept
+		{
+			assert(index < m_size);
+			return m_data[index];
+		}
+
+		const T* begin() const noexcept { return m_data; }
+		const T* end() const noexcept { return m_data + m_size; }
+	};
+}
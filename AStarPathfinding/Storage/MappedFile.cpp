@@ -0,0 +1,92 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "MappedFile.h"
+
+namespace Storage
+{
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& fileName)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr)
+			return false;
+
+		//the view keeps the mapping alive
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr)
+			return false;
+
+		m_data = static_cast<const unsigned char*>(data);
+		m_size = size_t(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+
+		m_data = nullptr;
+		m_size = 0u;
+	}
+#else
+	bool MappedFile::Open(const std::string& fileName)
+	{
+		Close();
+
+		const int file = open(fileName.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status {};
+		if (fstat(file, &status) != 0 || status.st_size <= 0)
+		{
+			close(file);
+			return false;
+		}
+
+		//the mapping keeps the file alive
+		void* data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_data = static_cast<const unsigned char*>(data);
+		m_size = size_t(status.st_size);
+		return true;
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (m_data != nullptr)
+			munmap(const_cast<unsigned char*>(m_data), m_size);
+
+		m_data = nullptr;
+		m_size = 0u;
+	}
+#endif
+}
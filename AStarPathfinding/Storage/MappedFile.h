@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+namespace Storage
+{
+	/// <summary>
+	/// Файл, отображённый в память только для чтения (mmap / MapViewOfFile).
+	///
+	/// Страницы читаются с диска при первом обращении, поэтому Open не зависит от размера файла.
+	/// </summary>
+	class MappedFile final
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { Close(); }
+
+		//false for a missing or empty file
+		bool Open(const std::string& fileName);
+		void Close() noexcept;
+
+		bool IsOpen() const noexcept { return m_data != nullptr; }
+		const unsigned char* GetData() const noexcept { return m_data; }
+		size_t GetSize() const noexcept { return m_size; }
+
+	private:
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0u;
+	};
+}
@@ -0,0 +1,174 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <algorithm>
+
+#include "Snapshot.h"
+
+namespace Storage
+{
+	namespace
+	{
+		bool ReplaceFile(const std::string& fileName, const std::string& newFileName)
+		{
+#ifdef _WIN32
+			return MoveFileExA(newFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			//atomic: a reader opens either the old or the new file
+			return std::rename(newFileName.c_str(), fileName.c_str()) == 0;
+#endif
+		}
+	}
+
+	SnapshotWriter::~SnapshotWriter()
+	{
+		Discard();
+	}
+
+	bool SnapshotWriter::Open(const std::string& fileName)
+	{
+		Discard();
+
+		m_table.clear();
+		m_offset = 0u;
+		m_fileName = fileName;
+		m_tempFileName = fileName + ".tmp";
+
+		m_output.open(m_tempFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!m_output.is_open())
+			return false;
+
+		//placeholder, the real header is written by Close
+		const details::SnapshotHeader header;
+		m_output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		m_offset = sizeof(header);
+
+		return bool(m_output);
+	}
+
+	bool SnapshotWriter::AddSection(SnapshotSection id, const void* data, size_t size)
+	{
+		assert(std::none_of(std::begin(m_table), std::end(m_table),
+			[id](const details::SnapshotTableEntry& entry) { return entry.Id == id; }));
+
+		if (!Pad(SnapshotSectionAlignment))
+			return false;
+
+		details::SnapshotTableEntry entry;
+		entry.Id = id;
+		entry.Offset = m_offset;
+		entry.Size = size;
+		m_table.emplace_back(entry);
+
+		if (size > 0u)
+			m_output.write(static_cast<const char*>(data), std::streamsize(size));
+		m_offset += size;
+
+		return bool(m_output);
+	}
+
+	bool SnapshotWriter::Close()
+	{
+		if (!Pad(alignof(details::SnapshotTableEntry)))
+			return false;
+
+		details::SnapshotHeader header;
+		header.Magic = SnapshotMagic;
+		header.Version = SnapshotVersion;
+		header.SectionCount = uint32_t(m_table.size());
+		header.TableOffset = m_offset;
+		header.FileSize = m_offset + m_table.size() * sizeof(details::SnapshotTableEntry);
+
+		m_output.write(reinterpret_cast<const char*>(m_table.data()), std::streamsize(m_table.size() * sizeof(details::SnapshotTableEntry)));
+		m_output.seekp(0);
+		m_output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		m_output.close();
+
+		if (m_output.fail() || !ReplaceFile(m_fileName, m_tempFileName))
+		{
+			std::remove(m_tempFileName.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	void SnapshotWriter::Discard()
+	{
+		if (!m_output.is_open())
+			return;
+
+		m_output.close();
+		std::remove(m_tempFileName.c_str());
+	}
+
+	bool SnapshotWriter::Pad(size_t alignment)
+	{
+		static const char zeros[SnapshotSectionAlignment] = {};
+
+		const size_t padding = size_t((alignment - m_offset % alignment) % alignment);
+		m_output.write(zeros, std::streamsize(padding));
+		m_offset += padding;
+
+		return bool(m_output);
+	}
+
+	bool Snapshot::Open(const std::string& fileName)
+	{
+		Close();
+
+		if (!m_file.Open(fileName) || m_file.GetSize() < sizeof(details::SnapshotHeader))
+		{
+			Close();
+			return false;
+		}
+
+		details::SnapshotHeader header;
+		std::memcpy(&header, m_file.GetData(), sizeof(header));
+
+		const uint64_t fileSize = m_file.GetSize();
+		const uint64_t tableSize = uint64_t(header.SectionCount) * sizeof(details::SnapshotTableEntry);
+
+		//a truncated or partly written file is rejected here
+		if (header.Magic != SnapshotMagic || header.Version != SnapshotVersion || header.FileSize != fileSize ||
+			header.TableOffset % alignof(details::SnapshotTableEntry) != 0u ||
+			header.TableOffset > fileSize || tableSize > fileSize - header.TableOffset)
+		{
+			Close();
+			return false;
+		}
+
+		m_table = ArrayView<details::SnapshotTableEntry>(
+			reinterpret_cast<const details::SnapshotTableEntry*>(m_file.GetData() + header.TableOffset), header.SectionCount);
+
+		for (auto&& entry : m_table)
+		{
+			if (entry.Offset % SnapshotSectionAlignment != 0u || entry.Offset > header.TableOffset ||
+				entry.Size > header.TableOffset - entry.Offset)
+			{
+				Close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Snapshot::Close() noexcept
+	{
+		m_table = ArrayView<details::SnapshotTableEntry>();
+		m_file.Close();
+	}
+
+	const details::SnapshotTableEntry* Snapshot::FindSection(SnapshotSection id) const noexcept
+	{
+		auto it = std::find_if(std::begin(m_table), std::end(m_table),
+			[id](const details::SnapshotTableEntry& entry) { return entry.Id == id; });
+
+		return it != std::end(m_table) ? &*it : nullptr;
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ArrayView.h"
+#include "MappedFile.h"
+
+/// <summary>
+/// snapshot file format, all values in the byte order of the writer:
+///
+/// header: magic, version, section count, section table offset, file size
+/// sections: raw arrays, each aligned to SectionAlignment
+/// section table: id, offset, size of every section
+///
+/// Sections are used in place from the mapped file, nothing is parsed on load.
+/// </summary>
+
+namespace Storage
+{
+	enum class SnapshotSection : uint32_t
+	{
+		MapHeader = 1u,
+		MapFields,
+
+		ConnectivityHeader,
+		ConnectivityLabels,
+
+		HierarchyHeader,
+		HierarchyCellToNode,
+		HierarchyNodeToCell,
+		HierarchyFirstEdge,
+		HierarchyEdges,
+	};
+
+	namespace details
+	{
+		struct SnapshotHeader final
+		{
+			uint32_t Magic = 0u;
+			uint32_t Version = 0u;
+			uint32_t SectionCount = 0u;
+			uint32_t Reserved = 0u;
+			uint64_t TableOffset = 0u;
+			uint64_t FileSize = 0u;
+		};
+
+		struct SnapshotTableEntry final
+		{
+			SnapshotSection Id = SnapshotSection::MapHeader;
+			uint32_t Reserved = 0u;
+			uint64_t Offset = 0u;
+			uint64_t Size = 0u;
+		};
+	}
+
+	//"APSN", a snapshot of the other byte order fails the magic check
+	constexpr uint32_t SnapshotMagic = 0x4E535041u;
+	//2: the map header has the size and the modification time of the map file
+	constexpr uint32_t SnapshotVersion = 2u;
+	//enough for any array element, also keeps every section on its own cache lines
+	constexpr size_t SnapshotSectionAlignment = 64u;
+
+	/// <summary>
+	/// Запись snapshot: секции пишутся во временный файл сразу, таблица секций и заголовок - в Close.
+	///
+	/// Close заменяет файл готовым snapshot, поэтому прерванная запись не портит прежний файл.
+	/// </summary>
+	class SnapshotWriter final
+	{
+	public:
+		SnapshotWriter() = default;
+		SnapshotWriter(const SnapshotWriter&) = delete;
+		SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+		//the temporary file of a writer which is not closed is removed
+		~SnapshotWriter();
+
+		bool Open(const std::string& fileName);
+		bool AddSection(SnapshotSection id, const void* data, size_t size);
+		//the file is replaced only if Close returns true; a mapped Snapshot of it must be closed before on Windows
+		bool Close();
+
+		template<typename T>
+		bool AddArray(SnapshotSection id, ArrayView<T> array)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot arrays are copied as raw bytes");
+			return AddSection(id, array.GetData(), array.GetSize() * sizeof(T));
+		}
+
+		template<typename T>
+		bool AddValue(SnapshotSection id, const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as raw bytes");
+			return AddSection(id, &value, sizeof(T));
+		}
+
+	private:
+		std::string m_fileName;
+		std::string m_tempFileName;
+		std::ofstream m_output;
+		std::vector<details::SnapshotTableEntry> m_table;
+		uint64_t m_offset = 0u;
+
+		bool Pad(size_t alignment);
+		//removes the temporary file of an unfinished write
+		void Discard();
+	};
+
+	/// <summary>
+	/// Snapshot, отображённый в память.
+	///
+	/// Open проверяет только заголовок и таблицу секций, массивы не копируются:
+	/// view из GetArray ссылаются на отображённый файл и живут не дольше Snapshot.
+	/// </summary>
+	class Snapshot final
+	{
+	public:
+		Snapshot() = default;
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+		~Snapshot() = default;
+
+		bool Open(const std::string& fileName);
+		void Close() noexcept;
+
+		bool IsOpen() const noexcept { return m_file.IsOpen(); }
+		size_t GetFileSize() const noexcept { return m_file.GetSize(); }
+		bool HasSection(SnapshotSection id) const noexcept { return FindSection(id) != nullptr; }
+
+		//false if the section is missing or its size is not a multiple of T
+		template<typename T>
+		bool GetArray(SnapshotSection id, ArrayView<T>& array) const noexcept
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot arrays are used as raw bytes");
+
+			const auto* section = FindSection(id);
+			if (section == nullptr || section->Size % sizeof(T) != 0u)
+				return false;
+
+			array = ArrayView<T>(reinterpret_cast<const T*>(m_file.GetData() + section->Offset), size_t(section->Size / sizeof(T)));
+			return true;
+		}
+
+		template<typename T>
+		bool GetValue(SnapshotSection id, T& value) const noexcept
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as raw bytes");
+
+			const auto* section = FindSection(id);
+			if (section == nullptr || section->Size != sizeof(T))
+				return false;
+
+			std::memcpy(&value, m_file.GetData() + section->Offset, sizeof(T));
+			return true;
+		}
+
+	private:
+		MappedFile m_file;
+		ArrayView<details::SnapshotTableEntry> m_table;
+
+		const details::SnapshotTableEntry* FindSection(SnapshotSection id) const noexcept;
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace Threading
+{
+	/// <summary>
+	/// lock-free multi producer / single consumer stack.
+	///
+	/// Push is safe from any thread, ConsumeAll only from the owner thread.
+	/// ConsumeAll takes the whole stack at once, so there is no ABA problem.
+	/// </summary>
+	template<typename T>
+	class MpscStack final
+	{
+		struct Node final
+		{
+			T Value;
+			Node* Next = nullptr;
+		};
+
+		std::atomic<Node*> m_head{ nullptr };
+
+	public:
+		MpscStack() = default;
+		MpscStack(const MpscStack&) = delete;
+		MpscStack& operator=(const MpscStack&) = delete;
+		~MpscStack()
+		{
+			ConsumeAll([](T&) {});
+		}
+
+		void Push(T&& value)
+		{
+			Node* node = new Node{ std::move(value), m_head.load(std::memory_order_relaxed) };
+			while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		bool IsEmpty() const noexcept { return m_head.load(std::memory_order_relaxed) == nullptr; }
+
+		//calls consumer for every value, the latest pushed first; returns values count
+		template<typename TConsumer>
+		size_t ConsumeAll(TConsumer&& consumer)
+		{
+			Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+			size_t count = 0u;
+			while (node != nullptr)
+			{
+				consumer(node->Value);
+
+				Node* next = node->Next;
+				delete node;
+				node = next;
+				++count;
+			}
+			return count;
+		}
+	};
+}
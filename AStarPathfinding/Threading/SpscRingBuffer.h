@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+namespace Threading
+{
+	/// <summary>
+	/// lock-free single producer / single consumer ring buffer with a fixed capacity.
+	///
+	/// TryPush only from the producer thread, TryPop and ConsumeAll only from the consumer thread.
+	/// A full buffer never blocks the producer: TryPush returns false.
+	/// </summary>
+	template<typename T>
+	class SpscRingBuffer final
+	{
+		//separate cache lines, so the producer and the consumer do not share the line they write
+		static constexpr size_t CacheLineSize = 64u;
+
+	public:
+		SpscRingBuffer() = delete;
+		//capacity is rounded up to a power of two
+		explicit SpscRingBuffer(size_t capacity) : m_buffer(RoundUpToPowerOfTwo(capacity)), m_mask(m_buffer.size() - 1u) {}
+		SpscRingBuffer(const SpscRingBuffer&) = delete;
+		SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+		~SpscRingBuffer() = default;
+
+		size_t GetCapacity() const noexcept { return m_buffer.size(); }
+
+		bool TryPush(const T& value)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_cachedHead == m_buffer.size())
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				if (tail - m_cachedHead == m_buffer.size())
+					return false;
+			}
+
+			m_buffer[tail & m_mask] = value;
+			m_tail.store(tail + 1u, std::memory_order_release);
+			return true;
+		}
+
+		bool TryPop(T& value)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_cachedTail)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				if (head == m_cachedTail)
+					return false;
+			}
+
+			value = m_buffer[head & m_mask];
+			m_head.store(head + 1u, std::memory_order_release);
+			return true;
+		}
+
+		//calls consumer for every value available now, in push order; returns values count
+		template<typename TConsumer>
+		size_t ConsumeAll(TConsumer&& consumer)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+			for (size_t i = head; i != m_cachedTail; ++i)
+			{
+				consumer(static_cast<const T&>(m_buffer[i & m_mask]));
+			}
+
+			//one release for the whole range, the producer sees all slots free at once
+			m_head.store(m_cachedTail, std::memory_order_release);
+			return m_cachedTail - head;
+		}
+
+	private:
+		std::vector<T> m_buffer;
+		const size_t m_mask;
+
+		//consumer side
+		alignas(CacheLineSize) std::atomic<size_t> m_head{ 0u };
+		size_t m_cachedTail = 0u;
+
+		//producer side
+		alignas(CacheLineSize) std::atomic<size_t> m_tail{ 0u };
+		size_t m_cachedHead = 0u;
+
+		static size_t RoundUpToPowerOfTwo(size_t value) noexcept
+		{
+			assert(value > 0u);
+
+			size_t result = 1u;
+			while (result < value)
+				result <<= 1u;
+			return result;
+		}
+	};
+}
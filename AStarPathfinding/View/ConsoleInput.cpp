@@ -0,0 +1,87 @@
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "ConsoleInput.h"
+
+namespace View
+{
+	namespace
+	{
+		int GetArrowKey(int code)
+		{
+			switch (code)
+			{
+#ifdef _WIN32
+			case 72: return 'w';
+			case 80: return 's';
+			case 75: return 'a';
+			case 77: return 'd';
+#else
+			case 'A': return 'w';
+			case 'B': return 's';
+			case 'D': return 'a';
+			case 'C': return 'd';
+#endif
+			}
+			return 0;
+		}
+	}
+
+#ifdef _WIN32
+	ConsoleInput::ConsoleInput() = default;
+	ConsoleInput::~ConsoleInput() = default;
+
+	int ConsoleInput::ReadKey()
+	{
+		if (!_kbhit())
+			return 0;
+
+		const int key = _getch();
+		//arrows come as a prefix and a scan code
+		if (key == 0 || key == 224)
+			return GetArrowKey(_getch());
+
+		return key;
+	}
+#else
+	ConsoleInput::ConsoleInput()
+	{
+		if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &m_settings) != 0)
+			return;
+
+		//without ISIG Ctrl+C is read as InterruptKey, so the destructor always restores the terminal
+		termios settings = m_settings;
+		settings.c_lflag &= ~tcflag_t(ICANON | ECHO | ISIG);
+		settings.c_cc[VMIN] = 0;
+		settings.c_cc[VTIME] = 0;
+
+		m_restoreSettings = tcsetattr(STDIN_FILENO, TCSANOW, &settings) == 0;
+	}
+
+	ConsoleInput::~ConsoleInput()
+	{
+		if (m_restoreSettings)
+			tcsetattr(STDIN_FILENO, TCSANOW, &m_settings);
+	}
+
+	int ConsoleInput::ReadKey()
+	{
+		if (!m_restoreSettings)
+			return 0;
+
+		unsigned char key = 0;
+		if (read(STDIN_FILENO, &key, 1) != 1)
+			return 0;
+
+		//arrows come as "ESC [ code"
+		unsigned char sequence[2] = {};
+		if (key == 0x1b && read(STDIN_FILENO, sequence, 2) == 2 && sequence[0] == '[')
+			return GetArrowKey(sequence[1]);
+
+		return key;
+	}
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef _WIN32
+#include <termios.h>
+#endif
+
+namespace View
+{
+	/// <summary>
+	/// Неблокирующее чтение клавиш из консоли.
+	///
+	/// Стрелки возвращаются как 'w', 's', 'a', 'd', Ctrl+C - как InterruptKey.
+	/// </summary>
+	class ConsoleInput final
+	{
+	public:
+		static constexpr int InterruptKey = 0x03;
+
+		ConsoleInput();
+		ConsoleInput(const ConsoleInput&) = delete;
+		ConsoleInput& operator=(const ConsoleInput&) = delete;
+		~ConsoleInput();
+
+		//0 if no key is pressed
+		int ReadKey();
+
+	private:
+#ifndef _WIN32
+		termios m_settings{};
+		bool m_restoreSettings = false;
+#endif
+	};
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include "ConsoleRenderer.h"
+
+namespace View
+{
+	constexpr size_t ConsoleRenderer::StatusHeight;
+
+	namespace
+	{
+		constexpr const char* ClearScreen = "\x1b[2J";
+		constexpr const char* ClearLineEnd = "\x1b[K";
+		constexpr const char* HideCursor = "\x1b[?25l";
+		constexpr const char* ShowCursor = "\x1b[?25h";
+
+		void EnableVirtualTerminal()
+		{
+#ifdef _WIN32
+			HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+			DWORD mode = 0;
+			if (output != INVALID_HANDLE_VALUE && GetConsoleMode(output, &mode))
+				SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+		}
+	}
+
+	ConsoleRenderer::ConsoleRenderer(std::ostream& output, size_t viewportWidth, size_t viewportHeight) :
+		m_output(output),
+		m_viewportWidth(viewportWidth),
+		m_viewportHeight(viewportHeight),
+		m_frontBuffer(viewportWidth, viewportHeight)
+	{
+		EnableVirtualTerminal();
+	}
+
+	ConsoleRenderer::~ConsoleRenderer()
+	{
+		m_buffer.clear();
+		AppendCursorPosition(StatusHeight + m_viewportHeight, 0u);
+		m_buffer += ShowCursor;
+		m_buffer += '\n';
+
+		Flush();
+	}
+
+	void ConsoleRenderer::SetStatus(const std::string& status)
+	{
+		if (status == m_status)
+			return;
+
+		m_status = status;
+		m_statusDirty = true;
+	}
+
+	void ConsoleRenderer::Move(ptrdiff_t dX, ptrdiff_t dY) noexcept
+	{
+		m_moveX += dX;
+		m_moveY += dY;
+	}
+
+	void ConsoleRenderer::Draw(const Math::Matrix2d<char>& view)
+	{
+		const size_t width = std::min(m_viewportWidth, view.GetWidth());
+		const size_t height = std::min(m_viewportHeight, view.GetHeight());
+
+		m_buffer.clear();
+
+		if (m_invalid)
+		{
+			m_buffer += HideCursor;
+			m_buffer += ClearScreen;
+			m_statusDirty = true;
+		}
+
+		if (m_statusDirty)
+		{
+			size_t begin = 0u;
+			for (size_t row = 0; row < StatusHeight; ++row)
+			{
+				const size_t end = std::min(m_status.find('\n', begin), m_status.size());
+
+				AppendCursorPosition(row, 0u);
+				if (begin < end)
+					m_buffer.append(m_status, begin, end - begin);
+				m_buffer += ClearLineEnd;
+
+				begin = std::min(end + 1u, m_status.size());
+			}
+			m_statusDirty = false;
+		}
+
+		ClampOrigin(view, width, height);
+
+		for (size_t x = 0; x < height; ++x)
+		{
+			size_t first = width;
+			size_t last = 0u;
+
+			for (size_t y = 0; y < width; ++y)
+			{
+				const Math::Vector2d viewPosition{ m_origin.X + x, m_origin.Y + y };
+				const Math::Vector2d screenPosition{ x, y };
+
+				const char field = view.GetField(viewPosition);
+				if (m_invalid || field != m_frontBuffer.GetField(screenPosition))
+				{
+					first = std::min(first, y);
+					last = y;
+					m_frontBuffer.SetField(screenPosition, field);
+				}
+			}
+
+			if (first == width)
+				continue;
+
+			//one write for the whole changed span, unchanged fields inside it are cheaper than cursor moves
+			AppendCursorPosition(StatusHeight + x, first);
+			for (size_t y = first; y <= last; ++y)
+			{
+				m_buffer += m_frontBuffer.GetField(Math::Vector2d{ x, y });
+			}
+		}
+		m_invalid = false;
+
+		Flush();
+	}
+
+	void ConsoleRenderer::ClampOrigin(const Math::Matrix2d<char>& view, size_t width, size_t height) noexcept
+	{
+		auto clamp = [](size_t value, ptrdiff_t delta, size_t max) -> size_t
+		{
+			if (delta < 0 && size_t(-delta) > value)
+				return 0u;
+			return std::min(size_t(ptrdiff_t(value) + delta), max);
+		};
+
+		m_origin.X = clamp(m_origin.X, m_moveX, view.GetHeight() - height);
+		m_origin.Y = clamp(m_origin.Y, m_moveY, view.GetWidth() - width);
+		m_moveX = 0;
+		m_moveY = 0;
+	}
+
+	void ConsoleRenderer::AppendCursorPosition(size_t row, size_t column)
+	{
+		//ANSI positions are 1-based
+		m_buffer += "\x1b[";
+		m_buffer += std::to_string(row + 1u);
+		m_buffer += ';';
+		m_buffer += std::to_string(column + 1u);
+		m_buffer += 'H';
+	}
+
+	void ConsoleRenderer::Flush()
+	{
+		if (m_buffer.empty())
+			return;
+
+		m_output.write(m_buffer.data(), std::streamsize(m_buffer.size()));
+		m_output.flush();
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+#include "../Math/Vector2d.h"
+#include "../Math/Matrix2d.h"
+
+namespace View
+{
+	/// <summary>
+	/// Отрисовка части view в консоли (ANSI escape-последовательности).
+	///
+	/// Хранит то, что уже выведено на экран, и перерисовывает только изменившиеся
+	/// клетки: каждая строка с изменениями выводится одним куском от первой до
+	/// последней изменённой клетки, весь кадр - одной записью в поток.
+	/// </summary>
+	class ConsoleRenderer final
+	{
+	public:
+		//lines above the viewport reserved for the status text
+		static constexpr size_t StatusHeight = 3u;
+
+		ConsoleRenderer() = delete;
+		ConsoleRenderer(std::ostream& output, size_t viewportWidth, size_t viewportHeight);
+		ConsoleRenderer(const ConsoleRenderer&) = delete;
+		ConsoleRenderer& operator=(const ConsoleRenderer&) = delete;
+		~ConsoleRenderer();
+
+		//status lines are separated by '\n'
+		void SetStatus(const std::string& status);
+
+		//moves the viewport over the view, clamped by the view size on Draw
+		void Move(ptrdiff_t dX, ptrdiff_t dY) noexcept;
+		Math::Vector2d GetOrigin() const noexcept { return m_origin; }
+
+		//redraw everything on the next Draw
+		void Invalidate() noexcept { m_invalid = true; }
+
+		void Draw(const Math::Matrix2d<char>& view);
+
+	private:
+		std::ostream& m_output;
+		const size_t m_viewportWidth;
+		const size_t m_viewportHeight;
+
+		Math::Matrix2d<char> m_frontBuffer;
+		Math::Vector2d m_origin;
+		//not yet clamped move
+		ptrdiff_t m_moveX = 0;
+		ptrdiff_t m_moveY = 0;
+		bool m_invalid = true;
+
+		std::string m_status;
+		bool m_statusDirty = true;
+
+		std::string m_buffer;
+
+		void ClampOrigin(const Math::Matrix2d<char>& view, size_t width, size_t height) noexcept;
+		void AppendCursorPosition(size_t row, size_t column);
+		void Flush();
+	};
+}
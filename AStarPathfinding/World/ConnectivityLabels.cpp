@@ -0,0 +1,122 @@
+#include <cassert>
+#include <limits>
+
+#include "ConnectivityLabels.h"
+
+namespace World
+{
+	constexpr uint32_t ConnectivityLabels::ObstacleLabel;
+
+	namespace
+	{
+		struct ConnectivitySnapshotHeader final
+		{
+			uint64_t Width = 0u;
+			uint64_t Height = 0u;
+			uint64_t ComponentCount = 0u;
+			uint32_t HasDiagonalMove = 0u;
+			uint32_t Reserved = 0u;
+		};
+	}
+
+	void ConnectivityLabels::Build(const Map2d& map, bool hasDiagonalMove)
+	{
+		assert(map.GetWidth() * map.GetHeight() <= std::numeric_limits<uint32_t>::max());
+
+		m_width = map.GetWidth();
+		m_height = map.GetHeight();
+		m_hasDiagonalMove = hasDiagonalMove;
+		m_componentCount = 0u;
+
+		m_labelsStorage.assign(m_width * m_height, ObstacleLabel);
+
+		std::vector<Math::Vector2d> stack;
+
+		auto visit = [&](const Math::Vector2d& position, uint32_t label)
+		{
+			if (!map.IsInside(position) || map.GetField(position) == FieldType::Obstacle)
+				return;
+
+			auto& cellLabel = m_labelsStorage[position.X * m_width + position.Y];
+			if (cellLabel != ObstacleLabel)
+				return;
+
+			cellLabel = label;
+			stack.emplace_back(position);
+		};
+
+		for (size_t x = 0; x < m_height; ++x)
+		{
+			for (size_t y = 0; y < m_width; ++y)
+			{
+				const Math::Vector2d position{ x, y };
+				if (map.GetField(position) == FieldType::Obstacle || m_labelsStorage[x * m_width + y] != ObstacleLabel)
+					continue;
+
+				const uint32_t label = uint32_t(m_componentCount++);
+				visit(position, label);
+
+				//the same moves as the finders use, so a label is exactly a reachable area
+				while (!stack.empty())
+				{
+					const auto current = stack.back();
+					stack.pop_back();
+
+					if (m_hasDiagonalMove)
+					{
+						for (auto&& neighbour : Math::GetNeighours8way(current))
+							visit(neighbour, label);
+					}
+					else
+					{
+						for (auto&& neighbour : Math::GetNeighours4way(current))
+							visit(neighbour, label);
+					}
+				}
+			}
+		}
+
+		m_labels = Storage::ArrayView<uint32_t>(m_labelsStorage);
+	}
+
+	bool ConnectivityLabels::AddToSnapshot(Storage::SnapshotWriter& writer) const
+	{
+		ConnectivitySnapshotHeader header;
+		header.Width = m_width;
+		header.Height = m_height;
+		header.ComponentCount = m_componentCount;
+		header.HasDiagonalMove = m_hasDiagonalMove ? 1u : 0u;
+
+		return writer.AddValue(Storage::SnapshotSection::ConnectivityHeader, header) &&
+			writer.AddArray(Storage::SnapshotSection::ConnectivityLabels, m_labels);
+	}
+
+	bool ConnectivityLabels::Load(const Storage::Snapshot& snapshot)
+	{
+		ConnectivitySnapshotHeader header;
+		Storage::ArrayView<uint32_t> labels;
+		if (!snapshot.GetValue(Storage::SnapshotSection::ConnectivityHeader, header) ||
+			!snapshot.GetArray(Storage::SnapshotSection::ConnectivityLabels, labels))
+			return false;
+
+		//a corrupt size must not wrap around to the size of the section
+		if (header.Width != 0u && header.Height > std::numeric_limits<size_t>::max() / header.Width)
+			return false;
+		if (labels.GetSize() != header.Width * header.Height || header.ComponentCount > labels.GetSize())
+			return false;
+		for (const uint32_t label : labels)
+		{
+			if (label != ObstacleLabel && label >= header.ComponentCount)
+				return false;
+		}
+
+		m_width = size_t(header.Width);
+		m_height = size_t(header.Height);
+		m_hasDiagonalMove = header.HasDiagonalMove != 0u;
+		m_componentCount = size_t(header.ComponentCount);
+
+		m_labelsStorage = std::vector<uint32_t>();
+		m_labels = labels;
+		return true;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "Map2d.h"
+#include "../Math/Vector2d.h"
+#include "../Storage/ArrayView.h"
+#include "../Storage/Snapshot.h"
+
+namespace World
+{
+	/// <summary>
+	/// Метки связных областей свободных клеток Map2d.
+	///
+	/// Путь между клетками существует только если у них одна метка,
+	/// так недостижимая цель отсекается без поиска.
+	/// </summary>
+	class ConnectivityLabels final
+	{
+	public:
+		static constexpr uint32_t ObstacleLabel = UINT32_MAX;
+
+		ConnectivityLabels() = default;
+		ConnectivityLabels(const ConnectivityLabels&) = delete;
+		ConnectivityLabels& operator=(const ConnectivityLabels&) = delete;
+		~ConnectivityLabels() = default;
+
+		void Build(const Map2d& map, bool hasDiagonalMove);
+
+		bool AddToSnapshot(Storage::SnapshotWriter& writer) const;
+		//labels are used in place, the snapshot must outlive them
+		bool Load(const Storage::Snapshot& snapshot);
+
+		size_t GetWidth() const noexcept { return m_width; }
+		size_t GetHeight() const noexcept { return m_height; }
+		bool HasDiagonalMove() const noexcept { return m_hasDiagonalMove; }
+		size_t GetComponentCount() const noexcept { return m_componentCount; }
+
+		//ObstacleLabel for obstacles and positions outside of the map
+		uint32_t GetLabel(const Math::Vector2d& position) const noexcept
+		{
+			if (position.X >= m_height || position.Y >= m_width)
+				return ObstacleLabel;
+			return m_labels[position.X * m_width + position.Y];
+		}
+
+		bool IsConnected(const Math::Vector2d& lhs, const Math::Vector2d& rhs) const noexcept
+		{
+			const uint32_t label = GetLabel(lhs);
+			return label != ObstacleLabel && label == GetLabel(rhs);
+		}
+
+	private:
+		size_t m_width = 0u;
+		size_t m_height = 0u;
+		bool m_hasDiagonalMove = true;
+		size_t m_componentCount = 0u;
+
+		//empty when the labels come from a snapshot
+		std::vector<uint32_t> m_labelsStorage;
+		Storage::ArrayView<uint32_t> m_labels;
+	};
+}
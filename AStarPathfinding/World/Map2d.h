@@ -3,8 +3,8 @@
 #include <array>
 #include <cassert>
 
-#include "..\Math\Vector2d.h"
-#include "..\Math\Matrix2d.h"
+#include "../Math/Vector2d.h"
+#include "../Math/Matrix2d.h"
 #include "FieldType.h"
 #include "IMap.h"
 
@@ -27,7 +27,9 @@ namespace World
 
 		Map2d() = delete;
 		Map2d(size_t width, size_t height) : m_fields(width, height){}
+		Map2d(size_t width, size_t height, const FieldType* fields) : m_fields(width, height, fields) {}
 		Map2d(const Map2d& map) : m_fields(map.m_fields) {}
+		Map2d& operator=(const Map2d& map) = default;
 		~Map2d() override = default;
 
 		const Math::Matrix2d<FieldType>& GetFields() const noexcept { return m_fields; }
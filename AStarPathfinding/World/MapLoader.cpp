@@ -0,0 +1,106 @@
+#include <fstream>
+#include <limits>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "MapLoader.h"
+
+namespace World
+{
+	namespace
+	{
+		struct MapSnapshotHeader final
+		{
+			uint64_t Width = 0u;
+			uint64_t Height = 0u;
+			uint64_t SourceSize = 0u;
+			int64_t SourceModificationTime = 0;
+		};
+	}
+
+	bool LoadMap(const std::string& fileName, Map2d& map, Math::Vector2d& beginPosition, Math::Vector2d& endPosition)
+	{
+		std::ifstream input(fileName, std::ios::in);
+		if (!input.is_open())
+			return false;
+
+		size_t width = 0u, height = 0u;
+		if (!(input >> width >> height))
+			return false;
+
+		Map2d result(width, height);
+
+		std::string buf;
+		for (size_t x = 0; x < result.GetHeight(); ++x)
+		{
+			if (!(input >> buf) || buf.size() < result.GetWidth())
+				return false;
+
+			for (size_t y = 0; y < result.GetWidth(); ++y)
+			{
+				Math::Vector2d position{ x, y };
+
+				switch (buf[y])
+				{
+				case InputEmptyField: result.SetField(position, FieldType::None); break;
+				case InputObstacle: result.SetField(position, FieldType::Obstacle); break;
+				case InputBeginPosition: beginPosition = position; break;
+				case InputEndPosition: endPosition = position; break;
+				}
+			}
+		}
+
+		map = result;
+		return true;
+	}
+
+	bool GetMapFileInfo(const std::string& fileName, MapFileInfo& info)
+	{
+#ifdef _WIN32
+		struct _stat64 status;
+		if (_stat64(fileName.c_str(), &status) != 0)
+			return false;
+#else
+		struct stat status;
+		if (stat(fileName.c_str(), &status) != 0)
+			return false;
+#endif
+
+		info.Size = uint64_t(status.st_size);
+		info.ModificationTime = int64_t(status.st_mtime);
+		return true;
+	}
+
+	bool AddToSnapshot(const Map2d& map, const MapFileInfo& source, Storage::SnapshotWriter& writer)
+	{
+		MapSnapshotHeader header;
+		header.Width = map.GetWidth();
+		header.Height = map.GetHeight();
+		header.SourceSize = source.Size;
+		header.SourceModificationTime = source.ModificationTime;
+
+		const auto& fields = map.GetFields();
+		return writer.AddValue(Storage::SnapshotSection::MapHeader, header) &&
+			writer.AddArray(Storage::SnapshotSection::MapFields, Storage::ArrayView<FieldType>(fields.GetData(), map.GetWidth() * map.GetHeight()));
+	}
+
+	bool LoadMap(const Storage::Snapshot& snapshot, Map2d& map, MapFileInfo& source)
+	{
+		MapSnapshotHeader header;
+		Storage::ArrayView<FieldType> fields;
+		if (!snapshot.GetValue(Storage::SnapshotSection::MapHeader, header) ||
+			!snapshot.GetArray(Storage::SnapshotSection::MapFields, fields))
+			return false;
+
+		//a corrupt size must not wrap around to the size of the section
+		if (header.Width != 0u && header.Height > std::numeric_limits<size_t>::max() / header.Width)
+			return false;
+		if (fields.GetSize() != header.Width * header.Height)
+			return false;
+
+		map = Map2d(size_t(header.Width), size_t(header.Height), fields.GetData());
+		source.Size = header.SourceSize;
+		source.ModificationTime = header.SourceModificationTime;
+		return true;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include "Map2d.h"
+#include "../Math/Vector2d.h"
+#include "../Storage/Snapshot.h"
+
+/// <summary>
+/// text map format:
+///
+/// width height
+/// height rows of width characters:
+///   '0' - empty field, '1' - obstacle,
+///   'b' - begin position, 'e' - end position (both are empty fields)
+/// </summary>
+
+namespace World
+{
+	constexpr char InputObstacle = '1';
+	constexpr char InputEmptyField = '0';
+	constexpr char InputBeginPosition = 'b';
+	constexpr char InputEndPosition = 'e';
+
+	//identity of a map file, a snapshot of another identity was built from another version of the file
+	struct MapFileInfo final
+	{
+		uint64_t Size = 0u;
+		//seconds since the epoch
+		int64_t ModificationTime = 0;
+	};
+
+	inline bool operator==(const MapFileInfo& lhs, const MapFileInfo& rhs) noexcept
+	{
+		return lhs.Size == rhs.Size && lhs.ModificationTime == rhs.ModificationTime;
+	}
+	inline bool operator!=(const MapFileInfo& lhs, const MapFileInfo& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+	//begin/end positions are left untouched if the map has no 'b'/'e'
+	bool LoadMap(const std::string& fileName, Map2d& map, Math::Vector2d& beginPosition, Math::Vector2d& endPosition);
+	bool GetMapFileInfo(const std::string& fileName, MapFileInfo& info);
+
+	//source is the map file the map was loaded from
+	bool AddToSnapshot(const Map2d& map, const MapFileInfo& source, Storage::SnapshotWriter& writer);
+	//fields are copied from the mapped snapshot as is, nothing is parsed
+	bool LoadMap(const Storage::Snapshot& snapshot, Map2d& map, MapFileInfo& source);
+}
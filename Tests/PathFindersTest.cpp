@@ -0,0 +1,519 @@
+// PathFindersTest.cpp : every finder on a map file against a reference Dijkstra.
+//
+// usage: PathFindersTest <map file> [finder ...]
+//
+// finders: astar fixed ch parallel scheduler (default: all)
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <queue>
+#include <random>
+#include <future>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+#include "Math/Vector2d.h"
+#include "Math/Matrix2d.h"
+#include "World/Map2d.h"
+#include "World/MapLoader.h"
+#include "PathFinder/AStarPathFinder.h"
+#include "PathFinder/FixedPointAStarPathFinder.h"
+#include "PathFinder/ContractionHierarchy.h"
+#include "PathFinder/ContractionHierarchyPathFinder.h"
+#include "PathFinder/ParallelAStarPathFinder.h"
+#include "PathFinder/PathRequestScheduler.h"
+
+namespace
+{
+	constexpr size_t BeginCount = 4u;
+	constexpr size_t EndCount = 8u;
+	constexpr double BoundedEpsilon = 0.5;
+	//relative error of the fixed point diagonal cost is 0.01%
+	constexpr double FixedPointTolerance = 1e-3;
+	constexpr double Tolerance = 1e-6;
+
+	const double Infinity = std::numeric_limits<double>::infinity();
+
+	int failedCount = 0;
+
+	struct Query final
+	{
+		Math::Vector2d Begin;
+		Math::Vector2d End;
+		//reference Dijkstra weight, Infinity if there is no path
+		double Weight = 0.;
+	};
+
+	bool IsFree(const World::Map2d& map, const Math::Vector2d& position)
+	{
+		return map.IsInside(position) && map.GetField(position) != World::FieldType::Obstacle;
+	}
+
+	double GetDistance(const Math::Vector2d& lhs, const Math::Vector2d& rhs, bool hasDiagonalMove)
+	{
+		return hasDiagonalMove ? Math::EuclideanDistance(lhs, rhs) : double(Math::ManhattanDistance(lhs, rhs));
+	}
+
+	//weights from the begin to every cell of the map
+	Math::Matrix2d<double> FindWeights(const World::Map2d& map, const Math::Vector2d& begin, bool hasDiagonalMove)
+	{
+		Math::Matrix2d<double> weights(map.GetWidth(), map.GetHeight());
+		for (size_t x = 0; x < map.GetHeight(); ++x)
+		{
+			for (size_t y = 0; y < map.GetWidth(); ++y)
+				weights.SetField(Math::Vector2d{ x, y }, Infinity);
+		}
+
+		struct OpenNode final
+		{
+			double Weight = 0.;
+			Math::Vector2d Position;
+
+			bool operator > (const OpenNode& rhs) const noexcept { return Weight > rhs.Weight; }
+		};
+		std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> openList;
+
+		weights.SetField(begin, 0.);
+		openList.push(OpenNode{ 0., begin });
+
+		while (!openList.empty())
+		{
+			const auto node = openList.top();
+			openList.pop();
+			if (node.Weight > weights.GetField(node.Position))
+				continue;
+
+			auto expand = [&](const Math::Vector2d& position)
+			{
+				if (!IsFree(map, position))
+					return;
+
+				const double weight = node.Weight + GetDistance(node.Position, position, hasDiagonalMove);
+				if (weight < weights.GetField(position))
+				{
+					weights.SetField(position, weight);
+					openList.push(OpenNode{ weight, position });
+				}
+			};
+
+			if (hasDiagonalMove)
+			{
+				for (auto&& position : Math::GetNeighours8way(node.Position))
+					expand(position);
+			}
+			else
+			{
+				for (auto&& position : Math::GetNeighours4way(node.Position))
+					expand(position);
+			}
+		}
+
+		return weights;
+	}
+
+	std::vector<Query> CreateQueries(const World::Map2d& map, bool hasDiagonalMove, const Math::Vector2d& mapBegin, const Math::Vector2d& mapEnd)
+	{
+		std::vector<Math::Vector2d> freePositions;
+		for (size_t x = 0; x < map.GetHeight(); ++x)
+		{
+			for (size_t y = 0; y < map.GetWidth(); ++y)
+			{
+				if (IsFree(map, Math::Vector2d{ x, y }))
+					freePositions.emplace_back(Math::Vector2d{ x, y });
+			}
+		}
+		if (freePositions.empty())
+			return {};
+
+		std::mt19937 random(12345u);
+		std::uniform_int_distribution<size_t> distribution(0u, freePositions.size() - 1u);
+
+		std::vector<Math::Vector2d> begins;
+		if (IsFree(map, mapBegin))
+			begins.emplace_back(mapBegin);
+		while (begins.size() < BeginCount)
+			begins.emplace_back(freePositions[distribution(random)]);
+
+		std::vector<Query> result;
+		for (auto&& begin : begins)
+		{
+			const auto weights = FindWeights(map, begin, hasDiagonalMove);
+
+			std::vector<Math::Vector2d> ends = { begin };
+			if (begin == mapBegin && IsFree(map, mapEnd))
+				ends.emplace_back(mapEnd);
+			while (ends.size() < EndCount)
+				ends.emplace_back(freePositions[distribution(random)]);
+
+			for (auto&& end : ends)
+			{
+				result.emplace_back(Query{ begin, end, weights.GetField(end) });
+			}
+		}
+		return result;
+	}
+
+	void Check(bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << '\n';
+			++failedCount;
+		}
+	}
+
+	std::string ToString(const Query& query)
+	{
+		return "(" + std::to_string(query.Begin.X) + "," + std::to_string(query.Begin.Y) + ")->(" +
+			std::to_string(query.End.X) + "," + std::to_string(query.End.Y) + ")";
+	}
+
+	//path steps must be free neighbour cells ending at the end; returns the path weight, Infinity for an invalid path
+	double GetPathWeight(const World::Map2d& map, const Query& query, const PathFinder::IPath<Math::Vector2d>& path, bool hasDiagonalMove)
+	{
+		double result = 0.;
+		auto previous = query.Begin;
+		for (path.SetToBegin(); !path.IsEnd(); path.Next())
+		{
+			const auto position = path.GetCoordinates();
+			const size_t dX = position.X > previous.X ? position.X - previous.X : previous.X - position.X;
+			const size_t dY = position.Y > previous.Y ? position.Y - previous.Y : previous.Y - position.Y;
+			if (!IsFree(map, position) || dX > 1u || dY > 1u || dX + dY == 0u || (!hasDiagonalMove && dX + dY > 1u))
+				return Infinity;
+
+			result += GetDistance(previous, position, hasDiagonalMove);
+			previous = position;
+		}
+		path.SetToBegin();
+
+		return previous == query.End ? result : Infinity;
+	}
+
+	//maxRatio: the path weight may exceed the reference weight by this factor
+	void CheckResult(const std::string& name, const World::Map2d& map, const Query& query, PathFinder::IPathFinderResult result,
+		const PathFinder::IPath<Math::Vector2d>& path, bool hasDiagonalMove, double maxRatio, double tolerance)
+	{
+		const std::string message = name + (hasDiagonalMove ? " 8 way " : " 4 way ") + ToString(query);
+		if (query.Weight == Infinity)
+		{
+			Check(result == PathFinder::IPathFinderResult::NotFound, message + ": unreachable end is found");
+			return;
+		}
+		if (result != PathFinder::IPathFinderResult::Found)
+		{
+			Check(false, message + ": path is not found");
+			return;
+		}
+
+		const double weight = GetPathWeight(map, query, path, hasDiagonalMove);
+		Check(weight != Infinity, message + ": path is invalid");
+		Check(weight >= query.Weight * (1. - tolerance) - Tolerance, message + ": path is shorter than the reference");
+		Check(weight <= query.Weight * maxRatio * (1. + tolerance) + Tolerance,
+			message + ": path weight " + std::to_string(weight) + ", reference " + std::to_string(query.Weight));
+	}
+
+	void TestAStar(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		const std::pair<PathFinder::AStarTieBreaking, const char*> tieBreakings[] = {
+			{ PathFinder::AStarTieBreaking::Fifo, "astar fifo" },
+			{ PathFinder::AStarTieBreaking::Lifo, "astar lifo" },
+			{ PathFinder::AStarTieBreaking::LargerG, "astar g" },
+			{ PathFinder::AStarTieBreaking::CrossProduct, "astar cross" },
+		};
+		const std::pair<PathFinder::AStarSearchMode, const char*> boundedModes[] = {
+			{ PathFinder::AStarSearchMode::Weighted, "astar weighted" },
+			{ PathFinder::AStarSearchMode::Focal, "astar focal" },
+		};
+
+		PathFinder::AStarPathFinder finder(map);
+		finder.SetHasDiagonalMove(hasDiagonalMove);
+
+		for (auto&& tieBreaking : tieBreakings)
+		{
+			finder.SetTieBreaking(tieBreaking.first);
+			for (auto&& query : queries)
+			{
+				const auto result = finder.FindPath(query.Begin, query.End);
+				CheckResult(tieBreaking.second, map, query, result, finder.GetPath(), hasDiagonalMove, 1., Tolerance);
+			}
+		}
+
+		finder.SetTieBreaking(PathFinder::AStarTieBreaking::Fifo);
+		for (auto&& mode : boundedModes)
+		{
+			finder.SetSearchMode(mode.first, BoundedEpsilon);
+			for (auto&& query : queries)
+			{
+				const auto result = finder.FindPath(query.Begin, query.End);
+				CheckResult(mode.second, map, query, result, finder.GetPath(), hasDiagonalMove, 1. + BoundedEpsilon, Tolerance);
+			}
+		}
+
+		//keys saturate and the epsilon is clamped, any path is within the bound
+		for (auto&& mode : boundedModes)
+		{
+			for (const double epsilon : { 1e13, Infinity })
+			{
+				finder.SetSearchMode(mode.first, epsilon);
+				Check(finder.GetEpsilon() == PathFinder::AStarPathFinder::MaxEpsilon, std::string(mode.second) + ": huge epsilon is clamped");
+				for (auto&& query : queries)
+				{
+					const auto result = finder.FindPath(query.Begin, query.End);
+					CheckResult(std::string(mode.second) + " huge epsilon", map, query, result, finder.GetPath(), hasDiagonalMove,
+						std::numeric_limits<double>::max(), Tolerance);
+				}
+			}
+		}
+	}
+
+	void TestFixedPoint(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		PathFinder::FixedPointAStarPathFinder finder(map);
+		finder.SetHasDiagonalMove(hasDiagonalMove);
+
+		for (auto&& query : queries)
+		{
+			const auto result = finder.FindPath(query.Begin, query.End);
+			CheckResult("fixed", map, query, result, finder.GetPath(), hasDiagonalMove, 1., FixedPointTolerance);
+			if (result == PathFinder::IPathFinderResult::Found)
+			{
+				Check(std::abs(finder.GetPathWeight() - query.Weight) <= query.Weight * FixedPointTolerance + Tolerance,
+					"fixed " + ToString(query) + ": reported weight");
+			}
+		}
+	}
+
+	//one row of 65536 cells: costs near 2^16 fill the 32 bit range with the heuristic alone,
+	//so only the first two moves of a search fit it, while the bucket ring stays small
+	void TestFixedPointCostRange()
+	{
+		const World::Map2d map(65536u, 1u);
+		PathFinder::FixedPointAStarPathFinder finder(map);
+
+		const uint64_t maxCost = std::numeric_limits<uint32_t>::max();
+		const uint32_t straightCost = uint32_t(maxCost / (map.GetWidth() + map.GetHeight()));
+		Check(!finder.SetMoveCosts(straightCost * 2u, straightCost * 2u), "fixed: costs overflowing the heuristic are rejected");
+		Check(finder.GetStraightCost() == PathFinder::FixedPointAStarPathFinder::DefaultStraightCost, "fixed: rejected costs are not set");
+		Check(finder.SetMoveCosts(straightCost, straightCost), "fixed: costs fitting the heuristic are set");
+
+		const Math::Vector2d begin{ 0u, 0u };
+		for (const size_t length : { 1u, 2u, 3u, 65535u })
+		{
+			const bool found = finder.FindPath(begin, Math::Vector2d{ 0u, length }) == PathFinder::IPathFinderResult::Found;
+			//g of the third move is above the limit, the search stops before f of its children can wrap around
+			Check(found == (length <= 2u), "fixed: cost range of a path of " + std::to_string(length) + " moves");
+			if (found)
+				Check(uint64_t(finder.GetPathCost()) == uint64_t(length) * straightCost, "fixed: cost range path cost");
+		}
+	}
+
+	void TestContractionHierarchy(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		PathFinder::ContractionHierarchy hierarchy;
+		hierarchy.Build(map, hasDiagonalMove);
+		PathFinder::ContractionHierarchyPathFinder finder(hierarchy);
+
+		for (auto&& query : queries)
+		{
+			const auto result = finder.FindPath(query.Begin, query.End);
+			CheckResult("ch", map, query, result, finder.GetPath(), hasDiagonalMove, 1., Tolerance);
+			if (result == PathFinder::IPathFinderResult::Found)
+			{
+				Check(std::abs(finder.GetPathWeight() - query.Weight) <= query.Weight * Tolerance + Tolerance,
+					"ch " + ToString(query) + ": reported weight");
+			}
+		}
+	}
+
+	//the index of a larger map is cut off in its last array: every array but that one is read, then the load fails
+	void TestContractionHierarchyLoadFailure(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		const std::string fileName = "PathFindersTest.ch";
+		{
+			PathFinder::ContractionHierarchy largerHierarchy;
+			largerHierarchy.Build(World::Map2d(map.GetWidth() * 2u, map.GetHeight()), hasDiagonalMove);
+			Check(largerHierarchy.Save(fileName), "ch: index is saved");
+		}
+		{
+			std::ifstream input(fileName, std::ios::in | std::ios::binary);
+			std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+			input.close();
+			data.resize(data.size() - 1u);
+			std::ofstream(fileName, std::ios::out | std::ios::binary | std::ios::trunc) << data;
+		}
+
+		PathFinder::ContractionHierarchy hierarchy;
+		hierarchy.Build(map, hasDiagonalMove);
+		PathFinder::ContractionHierarchyPathFinder finder(hierarchy);
+		const size_t nodeCount = hierarchy.GetNodeCount();
+		const size_t edgeCount = hierarchy.GetEdgeCount();
+
+		Check(!hierarchy.Load(fileName), "ch: truncated index is rejected");
+		std::remove(fileName.c_str());
+		Check(hierarchy.GetNodeCount() == nodeCount && hierarchy.GetEdgeCount() == edgeCount, "ch: failed load keeps the hierarchy");
+
+		for (auto&& query : queries)
+		{
+			const auto result = finder.FindPath(query.Begin, query.End);
+			CheckResult("ch after failed load", map, query, result, finder.GetPath(), hasDiagonalMove, 1., Tolerance);
+		}
+	}
+
+	//a shortcut of the saved index is corrupted; edges are the last array of the file
+	void TestContractionHierarchyCorruptShortcut(const World::Map2d& map, bool hasDiagonalMove)
+	{
+		using Edge = PathFinder::ContractionHierarchy::Edge;
+		const std::string fileName = "PathFindersTest.ch";
+
+		PathFinder::ContractionHierarchy hierarchy;
+		hierarchy.Build(map, hasDiagonalMove);
+		Check(hierarchy.Save(fileName), "ch: index is saved");
+
+		std::string data;
+		{
+			std::ifstream input(fileName, std::ios::in | std::ios::binary);
+			data.assign((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		}
+		const size_t edgesOffset = data.size() - hierarchy.GetEdgeCount() * sizeof(Edge);
+
+		auto corrupt = [&](const std::function<void(Edge&)>& change, const std::string& message)
+		{
+			for (size_t offset = edgesOffset; offset < data.size(); offset += sizeof(Edge))
+			{
+				Edge edge;
+				std::memcpy(&edge, data.data() + offset, sizeof(Edge));
+				if (edge.Middle == PathFinder::ContractionHierarchy::InvalidNode)
+					continue;
+
+				std::string corruptData = data;
+				change(edge);
+				std::memcpy(&corruptData[offset], &edge, sizeof(Edge));
+				std::ofstream(fileName, std::ios::out | std::ios::binary | std::ios::trunc) << corruptData;
+
+				PathFinder::ContractionHierarchy loaded;
+				Check(!loaded.Load(fileName), "ch: shortcut " + message + " is rejected");
+				return;
+			}
+			Check(false, "ch: index has no shortcuts");
+		};
+
+		PathFinder::ContractionHierarchy loaded;
+		Check(loaded.Load(fileName), "ch: saved index is loaded");
+		//the middle is one of the ends: unpacking would never terminate
+		corrupt([](Edge& edge) { edge.Middle = edge.Target; }, "through its end");
+		corrupt([](Edge& edge) { edge.Weight *= 2.; }, "weight");
+		std::remove(fileName.c_str());
+	}
+
+	void TestParallel(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		PathFinder::ParallelAStarPathFinder finder(map, 4u);
+		finder.SetHasDiagonalMove(hasDiagonalMove);
+
+		for (auto&& query : queries)
+		{
+			const auto result = finder.FindPath(query.Begin, query.End);
+			CheckResult("parallel", map, query, result, finder.GetPath(), hasDiagonalMove, 1., Tolerance);
+			if (result == PathFinder::IPathFinderResult::Found)
+			{
+				Check(std::abs(finder.GetPathWeight() - query.Weight) <= query.Weight * Tolerance + Tolerance,
+					"parallel " + ToString(query) + ": reported weight");
+			}
+		}
+	}
+
+	void TestScheduler(const World::Map2d& map, const std::vector<Query>& queries, bool hasDiagonalMove)
+	{
+		PathFinder::PathRequestScheduler scheduler(map, 2u, hasDiagonalMove);
+		const auto deadline = PathFinder::PathRequestScheduler::Clock::now() + std::chrono::seconds(60);
+
+		std::vector<std::future<PathFinder::PathRequestResult>> futures;
+		for (auto&& query : queries)
+		{
+			futures.emplace_back(scheduler.Submit(query.Begin, query.End, deadline));
+		}
+		scheduler.Tick();
+
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			const auto result = futures[i].get();
+			CheckResult("scheduler", map, queries[i], result.Result, result.Path, hasDiagonalMove, 1., Tolerance);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: PathFindersTest <map file> [astar | fixed | ch | parallel | scheduler ...]\n";
+		return 1;
+	}
+
+	std::vector<std::string> finders(argv + 2, argv + argc);
+	if (finders.empty())
+		finders = { "astar", "fixed", "ch", "parallel", "scheduler" };
+
+	World::Map2d map(0, 0);
+	Math::Vector2d mapBegin, mapEnd;
+	if (!World::LoadMap(argv[1], map, mapBegin, mapEnd))
+	{
+		std::cerr << "can not load map: " << argv[1] << "\n";
+		return 1;
+	}
+	//maps without 'b'/'e' are searched corner to corner
+	if (mapBegin == mapEnd)
+	{
+		mapEnd = Math::Vector2d{ map.GetHeight() - 1u, map.GetWidth() - 1u };
+	}
+
+	for (const bool hasDiagonalMove : { true, false })
+	{
+		const auto queries = CreateQueries(map, hasDiagonalMove, mapBegin, mapEnd);
+		Check(!queries.empty(), "map has no free cells");
+
+		for (auto&& finder : finders)
+		{
+			if (finder == "astar")
+				TestAStar(map, queries, hasDiagonalMove);
+			else if (finder == "fixed")
+				TestFixedPoint(map, queries, hasDiagonalMove);
+			else if (finder == "ch")
+			{
+				TestContractionHierarchy(map, queries, hasDiagonalMove);
+				TestContractionHierarchyLoadFailure(map, queries, hasDiagonalMove);
+				TestContractionHierarchyCorruptShortcut(map, hasDiagonalMove);
+			}
+			else if (finder == "parallel")
+				TestParallel(map, queries, hasDiagonalMove);
+			else if (finder == "scheduler")
+				TestScheduler(map, queries, hasDiagonalMove);
+			else
+			{
+				std::cerr << "unknown finder: " << finder << "\n";
+				return 1;
+			}
+		}
+	}
+
+	if (std::find(std::begin(finders), std::end(finders), "fixed") != std::end(finders))
+		TestFixedPointCostRange();
+
+	if (failedCount > 0)
+	{
+		std::cerr << failedCount << " checks failed\n";
+		return 1;
+	}
+
+	std::cout << "all checks passed\n";
+	return 0;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <cmath>
+
+#include "PathFinder/PathRequestScheduler.h"
+#include "PathFinder/AStarPathFinder.h"
+#include "World/Map2d.h"
+#include "Math/Vector2d.h"
+
+namespace
+{
+	using Clock = PathFinder::PathRequestScheduler::Clock;
+
+	int failedCount = 0;
+
+	void Check(bool condition, const char* message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << '\n';
+			++failedCount;
+		}
+	}
+
+	double GetPathWeight(const Math::Vector2d& begin, const PathFinder::Path2d& path)
+	{
+		double result = 0.;
+		auto previous = begin;
+		for (path.SetToBegin(); !path.IsEnd(); path.Next())
+		{
+			result += Math::EuclideanDistance(previous, path.GetCoordinates());
+			previous = path.GetCoordinates();
+		}
+		return result;
+	}
+
+	//64x64 with a wall across the middle, the gap is at the right border
+	World::Map2d CreateMap()
+	{
+		World::Map2d map(64u, 64u);
+		for (size_t y = 0; y + 1u < map.GetWidth(); ++y)
+		{
+			map.SetField(Math::Vector2d{ 32u, y }, World::FieldType::Obstacle);
+		}
+		return map;
+	}
+
+	void TestSharedSearch(const World::Map2d& map)
+	{
+		PathFinder::PathRequestScheduler scheduler(map, 2u);
+		const auto deadline = Clock::now() + std::chrono::seconds(10);
+
+		const Math::Vector2d end{ 60u, 5u };
+		const std::vector<Math::Vector2d> begins = { { 2u, 2u }, { 2u, 2u }, { 2u, 2u }, { 10u, 40u }, { 30u, 0u } };
+
+		std::vector<std::future<PathFinder::PathRequestResult>> futures;
+		for (auto&& begin : begins)
+		{
+			futures.emplace_back(scheduler.Submit(begin, end, deadline));
+		}
+		scheduler.Tick();
+
+		PathFinder::AStarPathFinder finder(map);
+		for (size_t i = 0; i < begins.size(); ++i)
+		{
+			const auto result = futures[i].get();
+			Check(result.Result == PathFinder::IPathFinderResult::Found, "shared search: path is found");
+			Check(finder.FindPath(begins[i], end) == PathFinder::IPathFinderResult::Found, "shared search: reference path is found");
+
+			const double weight = GetPathWeight(begins[i], result.Path);
+			const double referenceWeight = GetPathWeight(begins[i], static_cast<const PathFinder::Path2d&>(finder.GetPath()));
+			Check(std::abs(weight - referenceWeight) < 1e-6, "shared search: path weight is optimal");
+		}
+
+		const auto metrics = scheduler.GetMetrics();
+		Check(metrics.Submitted == begins.size(), "shared search: submitted count");
+		Check(metrics.Completed == begins.size(), "shared search: completed count");
+		Check(metrics.Deduplicated == 2u, "shared search: identical requests are merged");
+		Check(metrics.Searches == 1u, "shared search: one search for the goal");
+		Check(metrics.SharedSearches == 1u, "shared search: the search is shared");
+	}
+
+	void TestInvalidRequests(const World::Map2d& map)
+	{
+		PathFinder::PathRequestScheduler scheduler(map, 1u);
+		const auto deadline = Clock::now() + std::chrono::seconds(10);
+
+		const Math::Vector2d obstacle{ 32u, 0u };
+		const Math::Vector2d outside{ 5000u, 5000u };
+		const Math::Vector2d free{ 0u, 0u };
+
+		std::vector<std::future<PathFinder::PathRequestResult>> futures;
+		futures.emplace_back(scheduler.Submit(outside, free, deadline));
+		futures.emplace_back(scheduler.Submit(obstacle, Math::Vector2d{ 1u, 1u }, deadline));
+		futures.emplace_back(scheduler.Submit(free, outside, deadline));
+		futures.emplace_back(scheduler.Submit(free, obstacle, deadline));
+		//shared search with one begin outside the map
+		futures.emplace_back(scheduler.Submit(outside, Math::Vector2d{ 60u, 60u }, deadline));
+		futures.emplace_back(scheduler.Submit(free, Math::Vector2d{ 60u, 60u }, deadline));
+		scheduler.Tick();
+
+		for (size_t i = 0; i + 1u < futures.size(); ++i)
+		{
+			Check(futures[i].get().Result == PathFinder::IPathFinderResult::NotFound, "invalid request: not found");
+		}
+		Check(futures.back().get().Result == PathFinder::IPathFinderResult::Found, "invalid request: valid request of the same goal is found");
+	}
+
+	void TestDeadlineOrder(const World::Map2d& map)
+	{
+		//one worker runs the jobs of a tick one by one
+		PathFinder::PathRequestScheduler scheduler(map, 1u);
+		const auto now = Clock::now();
+
+		const Math::Vector2d begin{ 0u, 0u };
+		const size_t goalCount = 6u;
+
+		//later goals get earlier deadlines
+		std::vector<std::future<PathFinder::PathRequestResult>> futures;
+		for (size_t i = 0; i < goalCount; ++i)
+		{
+			const Math::Vector2d end{ 63u, 10u * i };
+			futures.emplace_back(scheduler.Submit(begin, end, now + std::chrono::seconds(10 * (goalCount - i))));
+		}
+		scheduler.Tick();
+
+		std::vector<Clock::time_point> completionTimes;
+		for (auto&& future : futures)
+		{
+			const auto result = future.get();
+			Check(result.Result == PathFinder::IPathFinderResult::Found, "deadline order: path is found");
+			completionTimes.emplace_back(result.CompletionTime);
+		}
+
+		for (size_t i = 0; i + 1u < goalCount; ++i)
+		{
+			Check(completionTimes[i + 1u] < completionTimes[i], "deadline order: earlier deadline is served first");
+		}
+		Check(scheduler.GetMetrics().DeadlineMissed == 0u, "deadline order: no deadline is missed");
+	}
+
+	void TestPendingOnDestruction(const World::Map2d& map)
+	{
+		std::vector<std::future<PathFinder::PathRequestResult>> futures;
+		{
+			PathFinder::PathRequestScheduler scheduler(map, 1u);
+			const auto deadline = Clock::now() + std::chrono::seconds(10);
+
+			futures.emplace_back(scheduler.Submit(Math::Vector2d{ 0u, 0u }, Math::Vector2d{ 60u, 5u }, deadline));
+			scheduler.Tick();
+			//no tick after this one
+			futures.emplace_back(scheduler.Submit(Math::Vector2d{ 2u, 2u }, Math::Vector2d{ 60u, 60u }, deadline));
+		}
+
+		for (auto&& future : futures)
+		{
+			Check(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready, "destruction: request is completed");
+			Check(future.get().Result == PathFinder::IPathFinderResult::Found, "destruction: path is found");
+		}
+	}
+}
+
+int main()
+{
+	const auto map = CreateMap();
+
+	TestSharedSearch(map);
+	TestInvalidRequests(map);
+	TestDeadlineOrder(map);
+	TestPendingOnDestruction(map);
+
+	if (failedCount > 0)
+	{
+		std::cerr << failedCount << " checks failed\n";
+		return 1;
+	}
+
+	std::cout << "all checks passed\n";
+	return 0;
+}